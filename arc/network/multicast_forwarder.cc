@@ -11,6 +11,7 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 
+#include <algorithm>
 #include <utility>
 
 #include <base/bind.h>
@@ -23,8 +24,7 @@
 
 namespace {
 
-const int kNumTempSockets = 4;
-const int kBufSize = 1536;
+const size_t kNumTempSockets = 4;
 const int kCleanupIntervalMs = 5000;
 const int kCleanupTimeSeconds = 30;
 
@@ -32,6 +32,9 @@ const int kCleanupTimeSeconds = 30;
 
 namespace arc_networkd {
 
+constexpr unsigned int MulticastForwarder::kBatchSize;
+constexpr size_t MulticastForwarder::kBufSize;
+
 bool MulticastForwarder::Start(const std::string& int_ifname,
                                const std::string& lan_ifname,
                                const std::string& mdns_ipaddr,
@@ -80,13 +83,37 @@ bool MulticastForwarder::Start(const std::string& int_ifname,
 // This callback is registered as part of MulticastSocket::Bind().
 // All of our sockets use this function as a common callback.
 void MulticastForwarder::OnFileCanReadWithoutBlocking(int fd) {
-  char data[kBufSize];
-  struct sockaddr_in fromaddr;
+  for (unsigned int i = 0; i < kBatchSize; ++i) {
+    rx_iovs_[i].iov_base = rx_data_[i];
+    rx_iovs_[i].iov_len = kBufSize;
+    memset(&rx_msgs_[i], 0, sizeof(rx_msgs_[i]));
+    rx_msgs_[i].msg_hdr.msg_name = &rx_addrs_[i];
+    rx_msgs_[i].msg_hdr.msg_namelen = sizeof(rx_addrs_[i]);
+    rx_msgs_[i].msg_hdr.msg_iov = &rx_iovs_[i];
+    rx_msgs_[i].msg_hdr.msg_iovlen = 1;
+  }
 
-  ssize_t bytes = MulticastSocket::RecvFromFd(fd, data, kBufSize, &fromaddr);
-  if (bytes < 0)
+  // Anything beyond one batch stays queued on the socket and is picked up
+  // on the next wakeup.
+  int count = MulticastSocket::RecvManyFromFd(fd, rx_msgs_, kBatchSize);
+  if (count <= 0)
     return;
 
+  for (unsigned int i = 0; i < static_cast<unsigned int>(count); ++i) {
+    if (rx_msgs_[i].msg_hdr.msg_namelen != sizeof(rx_addrs_[i])) {
+      LOG(WARNING) << "recvmmsg: unexpected src addr length "
+                   << rx_msgs_[i].msg_hdr.msg_namelen;
+      continue;
+    }
+    ForwardDatagram(fd, i);
+  }
+  FlushSends();
+}
+
+void MulticastForwarder::ForwardDatagram(int fd, unsigned int i) {
+  const struct sockaddr_in& fromaddr = rx_addrs_[i];
+  char* data = rx_data_[i];
+  ssize_t bytes = rx_msgs_[i].msg_len;
   unsigned short port = ntohs(fromaddr.sin_port);
 
   struct sockaddr_in dst = {0};
@@ -95,14 +122,17 @@ void MulticastForwarder::OnFileCanReadWithoutBlocking(int fd) {
   dst.sin_addr = mcast_addr_;
 
   // Forward traffic that is part of an existing connection.
-  for (auto& temp : temp_sockets_) {
-    if (fd == temp->fd()) {
-      int_socket_->SendTo(data, bytes, temp->int_addr);
-      return;
-    } else if (fd == int_socket_->fd() &&
-               fromaddr.sin_port == temp->int_addr.sin_port) {
+  if (fd == int_socket_->fd()) {
+    auto it = temp_sockets_.find(fromaddr.sin_port);
+    if (it != temp_sockets_.end()) {
       TranslateMdnsIp(data, bytes);
-      temp->SendTo(data, bytes, dst);
+      QueueSend(it->second.get(), dst, i, &int_to_lan_);
+      return;
+    }
+  } else {
+    auto it = temp_sockets_by_fd_.find(fd);
+    if (it != temp_sockets_by_fd_.end()) {
+      QueueSend(int_socket_.get(), it->second->int_addr, i, &lan_to_int_);
       return;
     }
   }
@@ -111,32 +141,97 @@ void MulticastForwarder::OnFileCanReadWithoutBlocking(int fd) {
   if (allow_stateless_ && port == port_) {
     if (fd == int_socket_->fd()) {
       TranslateMdnsIp(data, bytes);
-      lan_socket_->SendTo(data, bytes, dst);
+      QueueSend(lan_socket_.get(), dst, i, &int_to_lan_);
       return;
     } else if (fd == lan_socket_->fd()) {
-      int_socket_->SendTo(data, bytes, dst);
+      QueueSend(int_socket_.get(), dst, i, &lan_to_int_);
       return;
     }
   }
 
   // New connection.
-  if (fd != int_socket_->fd())
+  if (fd != int_socket_->fd()) {
+    lan_to_int_.dropped++;
     return;
+  }
+
+  MulticastSocket* temp = CreateTempSocket(fromaddr);
+  if (!temp) {
+    int_to_lan_.dropped++;
+    return;
+  }
+  QueueSend(temp, dst, i, &int_to_lan_);
+}
 
+void MulticastForwarder::QueueSend(MulticastSocket* sock,
+                                   const struct sockaddr_in& dst,
+                                   unsigned int i,
+                                   Counters* counters) {
+  if (sock != tx_socket_ || tx_count_ == kBatchSize)
+    FlushSends();
+
+  tx_socket_ = sock;
+  tx_counters_ = counters;
+  tx_iovs_[tx_count_].iov_base = rx_data_[i];
+  tx_iovs_[tx_count_].iov_len = rx_msgs_[i].msg_len;
+  tx_addrs_[tx_count_] = dst;
+  struct mmsghdr* msg = &tx_msgs_[tx_count_];
+  memset(msg, 0, sizeof(*msg));
+  msg->msg_hdr.msg_name = &tx_addrs_[tx_count_];
+  msg->msg_hdr.msg_namelen = sizeof(tx_addrs_[tx_count_]);
+  msg->msg_hdr.msg_iov = &tx_iovs_[tx_count_];
+  msg->msg_hdr.msg_iovlen = 1;
+  tx_count_++;
+}
+
+void MulticastForwarder::FlushSends() {
+  if (tx_count_ == 0)
+    return;
+
+  unsigned int sent = tx_socket_->SendMany(tx_msgs_, tx_count_);
+  tx_counters_->packets += sent;
+  tx_counters_->dropped += tx_count_ - sent;
+  // sendmmsg() only fills in msg_len for the datagrams it sent.
+  for (unsigned int j = 0; j < tx_count_; ++j)
+    tx_counters_->bytes += tx_msgs_[j].msg_len;
+
+  tx_socket_ = nullptr;
+  tx_counters_ = nullptr;
+  tx_count_ = 0;
+}
+
+MulticastSocket* MulticastForwarder::CreateTempSocket(
+    const struct sockaddr_in& fromaddr) {
   std::unique_ptr<MulticastSocket> new_sock(new MulticastSocket());
+  unsigned short port = ntohs(fromaddr.sin_port);
   if (!new_sock->Bind(lan_ifname_, mcast_addr_, port, this) &&
       !new_sock->Bind(lan_ifname_, mcast_addr_, 0, this))
-    return;
+    return nullptr;
   memcpy(&new_sock->int_addr, &fromaddr, sizeof(new_sock->int_addr));
 
-  new_sock->SendTo(data, bytes, dst);
+  // Idle entries are purged by CleanupTask, so the limit will only really be
+  // reached if the daemon is flooded with requests.
+  if (temp_sockets_.size() >= kNumTempSockets) {
+    auto lru = std::min_element(
+        temp_sockets_.begin(), temp_sockets_.end(),
+        [](const TempSocketMap::value_type& a,
+           const TempSocketMap::value_type& b) {
+          return a.second->last_used() < b.second->last_used();
+        });
+    EraseTempSocket(lru);
+  }
+
+  MulticastSocket* temp = new_sock.get();
+  temp_sockets_by_fd_[temp->fd()] = temp;
+  temp_sockets_[fromaddr.sin_port] = std::move(new_sock);
+  return temp;
+}
 
-  // This should ideally delete the LRU entry, but since idle entries are
-  // purged by CleanupTask, the limit will only really be reached if
-  // the daemon is flooded with requests.
-  while (temp_sockets_.size() > kNumTempSockets)
-    temp_sockets_.pop_back();
-  temp_sockets_.push_front(std::move(new_sock));
+void MulticastForwarder::EraseTempSocket(TempSocketMap::iterator it) {
+  if (it->second.get() == tx_socket_)
+    FlushSends();
+  temp_sockets_by_fd_.erase(it->second->fd());
+  temp_sockets_.erase(it);
 }
 
 void MulticastForwarder::TranslateMdnsIp(char* data, ssize_t bytes) {
@@ -186,12 +281,20 @@ void MulticastForwarder::TranslateMdnsIp(char* data, ssize_t bytes) {
 void MulticastForwarder::CleanupTask() {
   time_t exp = time(NULL) - kCleanupTimeSeconds;
   for (auto it = temp_sockets_.begin(); it != temp_sockets_.end();) {
-    if ((*it)->last_used() < exp)
-      it = temp_sockets_.erase(it);
+    if (it->second->last_used() < exp)
+      EraseTempSocket(it++);
     else
       it++;
   }
 
+  VLOG(2) << "Forwarding " << mcast_addr_ << ":" << port_ << " "
+          << int_ifname_ << " -> " << lan_ifname_ << ": "
+          << int_to_lan_.packets << " packets, " << int_to_lan_.bytes
+          << " bytes, " << int_to_lan_.dropped << " dropped; " << lan_ifname_
+          << " -> " << int_ifname_ << ": " << lan_to_int_.packets
+          << " packets, " << lan_to_int_.bytes << " bytes, "
+          << lan_to_int_.dropped << " dropped";
+
   base::MessageLoopForIO::current()->task_runner()->PostDelayedTask(
       FROM_HERE,
       base::Bind(&MulticastForwarder::CleanupTask, weak_factory_.GetWeakPtr()),
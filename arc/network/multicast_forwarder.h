@@ -6,10 +6,12 @@
 #define ARC_NETWORK_MULTICAST_FORWARDER_H_
 
 #include <netinet/ip.h>
+#include <stdint.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <time.h>
 
-#include <deque>
+#include <map>
 #include <memory>
 #include <string>
 
@@ -56,6 +58,38 @@ class MulticastForwarder : public MessageLoopForIO::Watcher {
   void OnFileCanWriteWithoutBlocking(int fd) override {}
 
  protected:
+  // Maximum number of datagrams read or written by a single recvmmsg() or
+  // sendmmsg() call.
+  static constexpr unsigned int kBatchSize = 16;
+  static constexpr size_t kBufSize = 1536;
+
+  using TempSocketMap = std::map<in_port_t, std::unique_ptr<MulticastSocket>>;
+
+  // Traffic counters for one forwarding direction.
+  struct Counters {
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    uint64_t dropped = 0;
+  };
+
+  // Handles the datagram stored in slot |i| of the receive batch, which was
+  // read from |fd|.
+  void ForwardDatagram(int fd, unsigned int i);
+
+  // Queues slot |i| of the receive batch to be sent to |dst| through |sock|.
+  // Consecutive datagrams for the same socket are sent with one sendmmsg().
+  void QueueSend(MulticastSocket* sock,
+                 const struct sockaddr_in& dst,
+                 unsigned int i,
+                 Counters* counters);
+  void FlushSends();
+
+  // Creates a socket on |lan_ifname_| for a new session initiated by
+  // |fromaddr| on the internal interface, evicting the least recently used
+  // session if the table is full.  Returns nullptr on failure.
+  MulticastSocket* CreateTempSocket(const struct sockaddr_in& fromaddr);
+  void EraseTempSocket(TempSocketMap::iterator it);
+
   // Rewrite mDNS A records pointing to |arc_ip_| so that they point to
   // |lan_ip_| instead, so that Android can advertise services to devices
   // on the LAN.  This modifies |data|, an incoming packet that is |bytes|
@@ -75,7 +109,27 @@ class MulticastForwarder : public MessageLoopForIO::Watcher {
 
   std::unique_ptr<MulticastSocket> int_socket_;
   std::unique_ptr<MulticastSocket> lan_socket_;
-  std::deque<std::unique_ptr<MulticastSocket>> temp_sockets_;
+  // Stateful sessions, keyed by the internal source port that initiated
+  // them, and the same sockets indexed by fd for replies from the LAN.
+  TempSocketMap temp_sockets_;
+  std::map<int, MulticastSocket*> temp_sockets_by_fd_;
+
+  // Receive batch.
+  char rx_data_[kBatchSize][kBufSize];
+  struct iovec rx_iovs_[kBatchSize];
+  struct sockaddr_in rx_addrs_[kBatchSize];
+  struct mmsghdr rx_msgs_[kBatchSize];
+
+  // Pending send batch, all going out through |tx_socket_|.
+  MulticastSocket* tx_socket_ = nullptr;
+  Counters* tx_counters_ = nullptr;
+  unsigned int tx_count_ = 0;
+  struct iovec tx_iovs_[kBatchSize];
+  struct sockaddr_in tx_addrs_[kBatchSize];
+  struct mmsghdr tx_msgs_[kBatchSize];
+
+  Counters int_to_lan_;
+  Counters lan_to_int_;
 
   base::WeakPtrFactory<MulticastForwarder> weak_factory_{this};
 
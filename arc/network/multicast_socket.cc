@@ -5,6 +5,7 @@
 #include "arc/network/multicast_socket.h"
 
 #include <arpa/inet.h>
+#include <errno.h>
 #include <net/if.h>
 #include <string.h>
 #include <sys/ioctl.h>
@@ -103,39 +104,46 @@ bool MulticastSocket::Bind(const std::string& ifname,
       fd.get(), true, MessageLoopForIO::WATCH_READ, &watcher_, parent);
 
   fd_ = std::move(fd);
+  last_used_ = time(NULL);
   return true;
 }
 
-bool MulticastSocket::SendTo(const void* data,
-                             size_t len,
-                             const struct sockaddr_in& addr) {
-  if (sendto(fd_.get(), data, len, 0,
-             reinterpret_cast<const struct sockaddr*>(&addr),
-             sizeof(struct sockaddr_in)) < 0) {
-    PLOG(WARNING) << "sendto failed";
-    return false;
+unsigned int MulticastSocket::SendMany(struct mmsghdr* msgs,
+                                       unsigned int vlen) {
+  unsigned int next = 0;
+  unsigned int sent = 0;
+  while (next < vlen) {
+    int ret = sendmmsg(fd_.get(), msgs + next, vlen - next, 0);
+    if (ret < 0) {
+      if (errno == EINTR)
+        continue;
+      PLOG(WARNING) << "sendmmsg failed";
+      // Skip the datagram that could not be sent and try the rest.
+      next++;
+      continue;
+    }
+    next += ret;
+    sent += ret;
   }
-  last_used_ = time(NULL);
-  return true;
+  if (sent > 0)
+    last_used_ = time(NULL);
+  return sent;
 }
 
 // static
-ssize_t MulticastSocket::RecvFromFd(int fd,
-                                    void* data,
-                                    size_t len,
-                                    struct sockaddr_in* addr) {
-  socklen_t addrlen = sizeof(*addr);
-  ssize_t bytes = recvfrom(fd, data, len, 0,
-                           reinterpret_cast<struct sockaddr*>(addr), &addrlen);
-  if (bytes < 0) {
-    PLOG(WARNING) << "recvfrom failed";
-    return -1;
-  }
-  if (addrlen != sizeof(*addr)) {
-    LOG(WARNING) << "recvfrom failed: unexpected src addr length " << addrlen;
+int MulticastSocket::RecvManyFromFd(int fd,
+                                    struct mmsghdr* msgs,
+                                    unsigned int vlen) {
+  int ret;
+  do {
+    ret = recvmmsg(fd, msgs, vlen, MSG_DONTWAIT, nullptr);
+  } while (ret < 0 && errno == EINTR);
+  if (ret < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK)
+      PLOG(WARNING) << "recvmmsg failed";
     return -1;
   }
-  return bytes;
+  return ret;
 }
 
 }  // namespace arc_networkd
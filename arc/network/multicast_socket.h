@@ -31,12 +31,16 @@ class MulticastSocket {
             const struct in_addr& mcast_addr,
             unsigned short port,
             MessageLoopForIO::Watcher* parent);
-  bool SendTo(const void* data, size_t len, const struct sockaddr_in& addr);
 
-  static ssize_t RecvFromFd(int fd,
-                            void* data,
-                            size_t len,
-                            struct sockaddr_in* addr);
+  // Sends the |vlen| datagrams in |msgs|, each to the address in its
+  // msg_name, using as few syscalls as possible.  Returns the number of
+  // datagrams that were sent.
+  unsigned int SendMany(struct mmsghdr* msgs, unsigned int vlen);
+
+  // Receives up to |vlen| pending datagrams from |fd| without blocking.  The
+  // caller sets up the buffers and address storage in |msgs|.  Returns the
+  // number of datagrams received, or -1 on error.
+  static int RecvManyFromFd(int fd, struct mmsghdr* msgs, unsigned int vlen);
 
   int fd() const { return fd_.get(); }
   time_t last_used() const { return last_used_; }
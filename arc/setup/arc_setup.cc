@@ -1358,6 +1358,7 @@ void ArcSetup::SetUpOwnershipForSdcardConfigfs() {
 }
 
 void ArcSetup::RestoreContext() {
+  base::ElapsedTimer timer;
   std::vector<base::FilePath> directories = {
       // Restore the label for the file now since this is the only place to do
       // so.
@@ -1379,6 +1380,9 @@ void ArcSetup::RestoreContext() {
     directories.push_back(arc_paths_->usb_devices_directory);
 
   EXIT_IF(!RestoreconRecursively(directories));
+  LOG(INFO) << "Restoring contexts took "
+            << timer.Elapsed().InMillisecondsRoundedUp() << "ms";
+  arc_setup_metrics_->SendRestoreContextTime(timer.Elapsed());
 }
 
 void ArcSetup::SetUpGraphicsSysfsContext() {
@@ -2011,6 +2015,7 @@ void ArcSetup::BindMountInContainerNamespaceOnPreChroot(
 }
 
 void ArcSetup::RestoreContextOnPreChroot(const base::FilePath& rootfs) {
+  base::ElapsedTimer timer;
   {
     // The list of container directories that need to be recursively re-labeled.
     // Note that "var/run" (the parent directory) is not in the list  because
@@ -2030,6 +2035,11 @@ void ArcSetup::RestoreContextOnPreChroot(const base::FilePath& rootfs) {
     // Transform |kDirectories| because the mount points are visible only in
     // |rootfs|. Note that Chrome OS' file_contexts does recognize paths with
     // the |rootfs| prefix.
+    // "var/run/arc/apkcache" and "var/run/arc/dalvik-cache" are bind mounts
+    // from the stateful partition. libselinux records the file_contexts
+    // digest in their security.restorecon_last xattr and skips the walk on
+    // the next boot when it still matches. The other trees are on sysfs,
+    // debugfs or tmpfs and are walked every time.
     EXIT_IF(!RestoreconRecursively(
         PrependPath(kDirectories.cbegin(), kDirectories.cend(), rootfs)));
   }
@@ -2042,6 +2052,9 @@ void ArcSetup::RestoreContextOnPreChroot(const base::FilePath& rootfs) {
         "var/run/inputbridge"};
     EXIT_IF(!Restorecon(PrependPath(kPaths.cbegin(), kPaths.cend(), rootfs)));
   }
+  LOG(INFO) << "Restoring contexts in the rootfs took "
+            << timer.Elapsed().InMillisecondsRoundedUp() << "ms";
+  arc_setup_metrics_->SendRestoreContextOnPreChrootTime(timer.Elapsed());
 }
 
 void ArcSetup::CreateDevColdbootDoneOnPreChroot(const base::FilePath& rootfs) {
@@ -23,6 +23,9 @@ constexpr char kCodeRelocationTime[] = "Arc.CodeRelocationTime";
 constexpr char kCodeSigningTime[] = "Arc.CodeSigningTime";
 constexpr char kCodeIntegrityCheckingTotalTime[] =
     "Arc.CodeIntegrityCheckingTotalTime";
+constexpr char kRestoreContextTime[] = "Arc.RestoreContextTime";
+constexpr char kRestoreContextOnPreChrootTime[] =
+    "Arc.RestoreContextOnPreChrootTime";
 constexpr char kSdkVersionUpgradeType[] = "Arc.SdkVersionUpgradeType";
 
 }  // namespace
@@ -71,6 +74,17 @@ bool ArcSetupMetrics::SendCodeIntegrityCheckingTotalTime(
   return SendDurationToUMA(kCodeIntegrityCheckingTotalTime, total_time);
 }
 
+bool ArcSetupMetrics::SendRestoreContextTime(
+    base::TimeDelta restore_context_time) {
+  return SendDurationToUMA(kRestoreContextTime, restore_context_time);
+}
+
+bool ArcSetupMetrics::SendRestoreContextOnPreChrootTime(
+    base::TimeDelta restore_context_time) {
+  return SendDurationToUMA(kRestoreContextOnPreChrootTime,
+                           restore_context_time);
+}
+
 bool ArcSetupMetrics::SendSdkVersionUpgradeType(
     ArcSdkVersionUpgradeType upgrade_type) {
   return metrics_library_->SendEnumToUMA(
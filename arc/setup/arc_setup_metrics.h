@@ -89,6 +89,14 @@ class ArcSetupMetrics {
   // fails.
   bool SendCodeIntegrityCheckingTotalTime(base::TimeDelta total_time);
 
+  // Sends the time restoring SELinux contexts of host-side files used by the
+  // container.
+  bool SendRestoreContextTime(base::TimeDelta restore_context_time);
+
+  // Sends the time restoring SELinux contexts in the container's rootfs before
+  // it chroots.
+  bool SendRestoreContextOnPreChrootTime(base::TimeDelta restore_context_time);
+
   // Sends the type of SDK version upgrade.
   bool SendSdkVersionUpgradeType(ArcSdkVersionUpgradeType upgrade_type);
 
@@ -85,6 +85,18 @@ TEST_F(ArcSetupMetricsTest, SendCodeIntegrityCheckingTotalTime) {
   arc_setup_metrics_.SendCodeIntegrityCheckingTotalTime(t);
 }
 
+TEST_F(ArcSetupMetricsTest, SendRestoreContextTime) {
+  base::TimeDelta t = base::TimeDelta::FromMilliseconds(2345);
+  EXPECT_CALL(*GetMetricsLibraryMock(), SendToUMA(_, 2345, _, _, _)).Times(1);
+  arc_setup_metrics_.SendRestoreContextTime(t);
+}
+
+TEST_F(ArcSetupMetricsTest, SendRestoreContextOnPreChrootTime) {
+  base::TimeDelta t = base::TimeDelta::FromMilliseconds(5432);
+  EXPECT_CALL(*GetMetricsLibraryMock(), SendToUMA(_, 5432, _, _, _)).Times(1);
+  arc_setup_metrics_.SendRestoreContextOnPreChrootTime(t);
+}
+
 TEST_F(ArcSetupMetricsTest, SendSdkVersionUpgradeType) {
   EXPECT_CALL(
       *GetMetricsLibraryMock(),
@@ -24,6 +24,7 @@
 #include <sys/stat.h>
 #include <sys/sysmacros.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 #include <sys/xattr.h>
 #include <unistd.h>
 
@@ -41,6 +42,7 @@
 #include <base/files/scoped_file.h>
 #include <base/json/json_reader.h>
 #include <base/logging.h>
+#include <base/posix/eintr_wrapper.h>
 #include <base/process/launch.h>
 #include <base/strings/string_number_conversions.h>
 #include <base/strings/string_split.h>
@@ -114,6 +116,51 @@ int RestoreConLogCallback(int type, const char* fmt, ...) {
   return 0;
 }
 
+// Relabels each of |paths| recursively in a child process of its own, so that
+// independent trees are walked in parallel. Processes are used rather than
+// threads because libselinux does not guarantee that selinux_restorecon() is
+// thread-safe. Forking is safe here as arc-setup is single-threaded.
+bool RestoreconRecursivelyInParallel(const std::vector<base::FilePath>& paths,
+                                     unsigned int restorecon_flags) {
+  // Load the file contexts once before forking, rather than in every child.
+  struct selabel_handle* handle = selinux_restorecon_default_handle();
+  if (!handle) {
+    PLOG(ERROR) << "Failed to load the file contexts for restorecon";
+    return false;
+  }
+  selinux_restorecon_set_sehandle(handle);
+
+  bool success = true;
+  std::vector<std::pair<pid_t, base::FilePath>> children;
+  for (const auto& path : paths) {
+    const pid_t pid = fork();
+    if (pid == 0) {
+      _exit(selinux_restorecon(path.value().c_str(), restorecon_flags) == 0
+                ? EXIT_SUCCESS
+                : EXIT_FAILURE);
+    }
+    if (pid < 0) {
+      PLOG(WARNING) << "Failed to fork for restorecon of " << path.value();
+      if (selinux_restorecon(path.value().c_str(), restorecon_flags) != 0) {
+        LOG(ERROR) << "Error in restorecon of " << path.value();
+        success = false;
+      }
+      continue;
+    }
+    children.emplace_back(pid, path);
+  }
+
+  for (const auto& child : children) {
+    int status;
+    if (HANDLE_EINTR(waitpid(child.first, &status, 0)) != child.first ||
+        !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+      LOG(ERROR) << "Error in restorecon of " << child.second.value();
+      success = false;
+    }
+  }
+  return success;
+}
+
 bool RestoreconInternal(const std::vector<base::FilePath>& paths,
                         bool is_recursive) {
   union selinux_callback cb;
@@ -124,6 +171,11 @@ bool RestoreconInternal(const std::vector<base::FilePath>& paths,
       (is_recursive ? SELINUX_RESTORECON_RECURSE : 0) |
       SELINUX_RESTORECON_REALPATH;
 
+  // Non-recursive calls touch a handful of inodes, which takes less time than
+  // forking.
+  if (is_recursive && paths.size() > 1)
+    return RestoreconRecursivelyInParallel(paths, restorecon_flags);
+
   bool success = true;
   for (const auto& path : paths) {
     if (selinux_restorecon(path.value().c_str(), restorecon_flags) != 0) {
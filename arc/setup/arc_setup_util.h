@@ -216,8 +216,8 @@ bool WaitForPaths(std::initializer_list<base::FilePath> paths,
 // ~200ms or more. Instead, use one of the mount/umount syscall wrappers above.
 bool LaunchAndWait(const std::vector<std::string>& argv);
 
-// Restores contexts of the |directories| and their contents recursively.
-// Returns true on success.
+// Restores contexts of the |directories| and their contents recursively. The
+// directories are processed in parallel. Returns true on success.
 bool RestoreconRecursively(const std::vector<base::FilePath>& directories);
 
 // Restores contexts of the |paths|. Returns true on success.
@@ -11,6 +11,7 @@
 #include <algorithm>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 #include <base/files/file_enumerator.h>
 #include <base/files/file_path.h>
@@ -21,6 +22,7 @@
 #include <base/json/json_string_value_serializer.h>
 #include <base/message_loop/message_loop.h>
 #include <base/strings/string_util.h>
+#include <base/time/time.h>
 #include <base/values.h>
 
 namespace biod {
@@ -119,9 +121,23 @@ bool BiodStorage::ReadRecordsForSingleUser(const std::string& user_id) {
       root_path_.Append(kBiod).Append(user_id).Append(biometrics_manager_name_);
   base::FileEnumerator enum_records(biod_path, false,
                                     base::FileEnumerator::FILES, "Record*");
-  bool read_all_records_successfully = true;
+  // Records are touched by MarkRecordMatched() on every match, so the
+  // modification time is the time of the last match (or of enrollment).
+  std::vector<std::pair<base::Time, FilePath>> record_paths;
   for (FilePath record_path = enum_records.Next(); !record_path.empty();
        record_path = enum_records.Next()) {
+    record_paths.emplace_back(enum_records.GetInfo().GetLastModifiedTime(),
+                              record_path);
+  }
+  std::sort(record_paths.begin(), record_paths.end(),
+            [](const std::pair<base::Time, FilePath>& a,
+               const std::pair<base::Time, FilePath>& b) {
+              return a.first > b.first;
+            });
+
+  bool read_all_records_successfully = true;
+  for (const auto& time_and_path : record_paths) {
+    const FilePath& record_path = time_and_path.second;
     std::string json_string;
     if (!base::ReadFileToString(record_path, &json_string)) {
       LOG(ERROR) << "Failed to read the string from " << record_path.value()
@@ -189,6 +205,27 @@ bool BiodStorage::ReadRecordsForSingleUser(const std::string& user_id) {
   return read_all_records_successfully;
 }
 
+bool BiodStorage::MarkRecordMatched(const std::string& user_id,
+                                    const std::string& record_id) {
+  if (!allow_access_) {
+    LOG(ERROR) << "Access to the storage mounts not yet allowed.";
+    return false;
+  }
+
+  FilePath record_storage_filename = root_path_.Append(kBiod)
+                                         .Append(user_id)
+                                         .Append(biometrics_manager_name_)
+                                         .Append(kRecordFileName + record_id);
+
+  const base::Time now = base::Time::Now();
+  if (!base::TouchFile(record_storage_filename, now, now)) {
+    LOG(ERROR) << "Fail to update the match time of record " << record_id
+               << ".";
+    return false;
+  }
+  return true;
+}
+
 bool BiodStorage::DeleteRecord(const std::string& user_id,
                                const std::string& record_id) {
   if (!allow_access_) {
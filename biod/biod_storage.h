@@ -47,10 +47,18 @@ class BiodStorage {
   bool ReadRecords(const std::unordered_set<std::string>& user_ids);
 
   // Read all records from disk for a single user. Uses a file enumerator to
-  // enumerate through all record files. Called whenever biod starts or when
-  // a new user logs in.
+  // enumerate through all record files. Records are loaded most recently
+  // matched first, going by the modification time that MarkRecordMatched()
+  // and WriteRecord() set, so that the fingers used last reach the MCU first
+  // and win if it runs out of template slots. Called whenever biod starts or
+  // when a new user logs in.
   bool ReadRecordsForSingleUser(const std::string& user_id);
 
+  // Set the modification time of one record file to now. Called whenever the
+  // record matches, so that ReadRecordsForSingleUser() loads it early.
+  bool MarkRecordMatched(const std::string& user_id,
+                         const std::string& record_id);
+
   // Delete one record file. User will be able to do this via UI. True if
   // this record does not exist on disk.
   bool DeleteRecord(const std::string& user_id, const std::string& record_id);
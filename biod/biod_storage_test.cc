@@ -5,6 +5,7 @@
 #include "biod/biod_storage.h"
 
 #include <algorithm>
+#include <limits>
 #include <unordered_set>
 #include <vector>
 
@@ -12,6 +13,7 @@
 #include <base/files/file_path.h>
 #include <base/files/file_util.h>
 #include <base/files/scoped_temp_dir.h>
+#include <base/time/time.h>
 #include <testing/gtest/include/gtest/gtest.h>
 
 namespace biod {
@@ -85,6 +87,11 @@ class BiodStorageTest : public ::testing::Test {
   base::FilePath root_path_;
   std::unique_ptr<BiodStorage> biod_storage_;
   std::vector<TestRecord> records_;
+  // Number of templates the fake MCU has room for. Like
+  // CrosFpBiometricsManager::LoadRecord, records past this are rejected.
+  size_t max_template_count_ = std::numeric_limits<size_t>::max();
+  // Number of load attempts, i.e. template uploads to the fake MCU.
+  int upload_count_ = 0;
 
  private:
   // LoadRecord is a callback passed to biod_storage_. It gets called when
@@ -94,6 +101,9 @@ class BiodStorageTest : public ::testing::Test {
                   const std::string& label,
                   const std::string& record_id,
                   const base::Value& data_value) {
+    ++upload_count_;
+    if (records_.size() >= max_template_count_)
+      return false;
     std::string data;
     data_value.GetAsString(&data);
     records_.push_back(TestRecord(record_id, user_id, label, data));
@@ -147,6 +157,70 @@ TEST_F(BiodStorageTest, DeleteRecord) {
   EXPECT_TRUE(records_.empty());
 }
 
+TEST_F(BiodStorageTest, ReadRecordsMostRecentlyWrittenFirst) {
+  const std::vector<TestRecord> kRecords = {
+      TestRecord(kRecordId1, kUserId1, kLabel1, kData1),
+      TestRecord(kRecordId2, kUserId1, kLabel2, kData2),
+      TestRecord(kRecordId3, kUserId1, kLabel3, kData3)};
+  // Modification times, in days before now, for each of kRecords.
+  const int kAgeInDays[] = {2, 0, 1};
+
+  const base::FilePath records_path = root_path_.Append("biod")
+                                          .Append(kUserId1)
+                                          .Append(kBiometricsManagerName);
+  const base::Time now = base::Time::Now();
+  for (size_t i = 0; i < kRecords.size(); ++i) {
+    EXPECT_TRUE(biod_storage_->WriteRecord(
+        kRecords[i], std::make_unique<base::Value>(kRecords[i].GetData())));
+    const base::Time mtime = now - base::TimeDelta::FromDays(kAgeInDays[i]);
+    EXPECT_TRUE(base::TouchFile(
+        records_path.Append(std::string("Record") + kRecords[i].GetId()),
+        mtime, mtime));
+  }
+
+  EXPECT_TRUE(biod_storage_->ReadRecordsForSingleUser(kUserId1));
+  ASSERT_EQ(3u, records_.size());
+  EXPECT_EQ(kRecords[1], records_[0]);
+  EXPECT_EQ(kRecords[2], records_[1]);
+  EXPECT_EQ(kRecords[0], records_[2]);
+}
+
+TEST_F(BiodStorageTest, MostRecentlyMatchedRecordReadyAfterFirstUpload) {
+  const std::vector<TestRecord> kRecords = {
+      TestRecord(kRecordId1, kUserId1, kLabel1, kData1),
+      TestRecord(kRecordId2, kUserId1, kLabel2, kData2),
+      TestRecord(kRecordId3, kUserId1, kLabel3, kData3)};
+  // Days since each record was written. kRecords[0] was enrolled first but
+  // is matched below without its template being updated.
+  const int kAgeInDays[] = {5, 3, 1};
+  // The fake MCU is smaller than the stored records.
+  max_template_count_ = 2;
+
+  const base::FilePath records_path = root_path_.Append("biod")
+                                          .Append(kUserId1)
+                                          .Append(kBiometricsManagerName);
+  const base::Time now = base::Time::Now();
+  for (size_t i = 0; i < kRecords.size(); ++i) {
+    EXPECT_TRUE(biod_storage_->WriteRecord(
+        kRecords[i], std::make_unique<base::Value>(kRecords[i].GetData())));
+    const base::Time mtime = now - base::TimeDelta::FromDays(kAgeInDays[i]);
+    EXPECT_TRUE(base::TouchFile(
+        records_path.Append(std::string("Record") + kRecords[i].GetId()),
+        mtime, mtime));
+  }
+
+  EXPECT_TRUE(biod_storage_->MarkRecordMatched(kUserId1, kRecordId1));
+
+  // The last record does not fit, so not every record is read successfully.
+  EXPECT_FALSE(biod_storage_->ReadRecordsForSingleUser(kUserId1));
+  EXPECT_EQ(3, upload_count_);
+  ASSERT_EQ(2u, records_.size());
+  // The finger the user matched last can be matched after a single upload,
+  // and the template left off the MCU is the least recently used one.
+  EXPECT_EQ(kRecords[0], records_[0]);
+  EXPECT_EQ(kRecords[2], records_[1]);
+}
+
 TEST_F(BiodStorageTest, GenerateNewRecordId) {
   // Check the two record ids are different.
   std::string record_id1(biod_storage_->GenerateNewRecordId());
@@ -549,6 +549,10 @@ void CrosFpBiometricsManager::DoMatchEvent(int attempt, uint32_t event) {
       result = ScanResult::SCAN_RESULT_SUCCESS;
 
       if (match_idx < records_.size()) {
+        // A cheap touch, so the finger is loaded early on the next start
+        // even if the MCU did not update its template.
+        biod_storage_.MarkRecordMatched(records_[match_idx].user_id,
+                                        records_[match_idx].record_id);
         records.push_back(records_[match_idx].record_id);
         matches.emplace(records_[match_idx].user_id, std::move(records));
       } else {
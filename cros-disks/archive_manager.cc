@@ -369,8 +369,14 @@ MountErrorType ArchiveManager::MountAVFSPath(const string& base_path,
   SandboxedProcess mount_process;
   mount_process.AddArgument(kAVFSMountProgram);
   mount_process.AddArgument("-o");
+  // With auto_cache, the kernel keeps the pages of a file read through AVFS
+  // across opens for as long as its size and modification time are unchanged.
+  // Only re-reads of data that was already read are served from the page
+  // cache; the first read at any offset still makes AVFS decompress the member
+  // from its start up to that offset.
   mount_process.AddArgument(base::StringPrintf(
-      "ro,nodev,noexec,nosuid,allow_other,user=%s,modules=subdir,subdir=%s",
+      "ro,nodev,noexec,nosuid,allow_other,auto_cache,user=%s,modules=subdir,"
+      "subdir=%s",
       kAVFSMountUser, base_path.c_str()));
   mount_process.AddArgument(avfs_path);
   mount_process.SetNoNewPrivileges();
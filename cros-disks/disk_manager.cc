@@ -45,51 +45,11 @@ const char kScsiSubsystem[] = "scsi";
 const char kScsiDevice[] = "scsi_device";
 const char kUdevAddAction[] = "add";
 const char kUdevChangeAction[] = "change";
+const char kUdevMoveAction[] = "move";
 const char kUdevRemoveAction[] = "remove";
 const char kPropertyDiskEjectRequest[] = "DISK_EJECT_REQUEST";
 const char kPropertyDiskMediaChange[] = "DISK_MEDIA_CHANGE";
 
-// An EnumerateBlockDevices callback that appends a Disk object, created from
-// |dev|, to |disks| if |dev| should not be ignored by cros-disks. Always
-// returns true to continue the enumeration in EnumerateBlockDevices.
-bool AppendDiskIfNotIgnored(vector<Disk>* disks, udev_device* dev) {
-  DCHECK(disks);
-  DCHECK(dev);
-
-  UdevDevice device(dev);
-  if (!device.IsIgnored())
-    disks->push_back(device.ToDisk());
-
-  return true;  // Continue the enumeration.
-}
-
-// An EnumerateBlockDevices callback that checks if |dev| matches |path|. If
-// it's a match, sets |match| to true and |disk| (if not NULL) to a Disk object
-// created from |dev|, and returns false to stop the enumeration in
-// EnumerateBlockDevices. Otherwise, sets |match| to false, leaves |disk|
-// unchanged, and returns true to continue the enumeration in
-// EnumerateBlockDevices.
-bool MatchDiskByPath(const string& path,
-                     bool* match,
-                     Disk* disk,
-                     udev_device* dev) {
-  DCHECK(match);
-  DCHECK(dev);
-
-  const char* sys_path = udev_device_get_syspath(dev);
-  const char* dev_path = udev_device_get_devpath(dev);
-  const char* dev_file = udev_device_get_devnode(dev);
-  *match = (sys_path && path == sys_path) || (dev_path && path == dev_path) ||
-           (dev_file && path == dev_file);
-  if (!*match)
-    return true;  // Not a match. Continue the enumeration.
-
-  if (disk)
-    *disk = UdevDevice(dev).ToDisk();
-
-  return false;  // Match. Stop enumeration.
-}
-
 }  // namespace
 
 DiskManager::DiskManager(const string& mount_root,
@@ -100,7 +60,8 @@ DiskManager::DiskManager(const string& mount_root,
       device_ejector_(device_ejector),
       udev_(udev_new()),
       udev_monitor_fd_(0),
-      eject_device_on_unmount_(true) {
+      eject_device_on_unmount_(true),
+      block_devices_scanned_(false) {
   CHECK(device_ejector_) << "Invalid device ejector";
   CHECK(udev_) << "Failed to initialize udev";
   udev_monitor_ = udev_monitor_new_from_netlink(udev_, "udev");
@@ -148,12 +109,64 @@ bool DiskManager::EmulateBlockDeviceEvent(const char* action,
 }
 
 vector<Disk> DiskManager::EnumerateDisks() const {
+  ScanBlockDevicesIfNeeded();
+
   vector<Disk> disks;
-  EnumerateBlockDevices(
-      base::Bind(&AppendDiskIfNotIgnored, base::Unretained(&disks)));
+  for (const auto& block_device : block_devices_) {
+    udev_device* dev =
+        udev_device_new_from_syspath(udev_, block_device.first.c_str());
+    if (!dev)
+      continue;
+
+    UdevDevice device(dev);
+    if (!device.IsIgnored())
+      disks.push_back(device.ToDisk());
+    udev_device_unref(dev);
+  }
   return disks;
 }
 
+void DiskManager::ScanBlockDevicesIfNeeded() const {
+  if (block_devices_scanned_)
+    return;
+
+  block_devices_.clear();
+  EnumerateBlockDevices(
+      base::Bind(&DiskManager::AddBlockDevice, base::Unretained(this)));
+  block_devices_scanned_ = true;
+}
+
+bool DiskManager::AddBlockDevice(udev_device* dev) const {
+  DCHECK(dev);
+
+  const char* sys_path = udev_device_get_syspath(dev);
+  if (sys_path) {
+    const char* dev_path = udev_device_get_devpath(dev);
+    const char* dev_file = udev_device_get_devnode(dev);
+    BlockDevicePaths& paths = block_devices_[sys_path];
+    paths.dev_path = dev_path ? dev_path : "";
+    paths.dev_file = dev_file ? dev_file : "";
+  }
+
+  return true;  // Continue the enumeration.
+}
+
+void DiskManager::UpdateBlockDevices(udev_device* dev, const char* action) {
+  // Until the first scan, there is nothing to keep up to date.
+  if (!block_devices_scanned_)
+    return;
+
+  if (strcmp(action, kUdevRemoveAction) == 0) {
+    block_devices_.erase(udev_device_get_syspath(dev));
+  } else if (strcmp(action, kUdevMoveAction) == 0) {
+    // The event does not carry the old sysfs path in a form that can be
+    // looked up directly, so rescan on the next query instead.
+    block_devices_scanned_ = false;
+  } else {
+    AddBlockDevice(dev);
+  }
+}
+
 void DiskManager::EnumerateBlockDevices(
     const base::Callback<bool(udev_device* dev)>& callback) const {
   udev_enumerate* enumerate = udev_enumerate_new(udev_);
@@ -290,6 +303,9 @@ bool DiskManager::GetDeviceEvents(DeviceEventList* events) {
   udev_device* dev = udev_monitor_receive_device(udev_monitor_);
   if (!dev) {
     LOG(WARNING) << "Ignore device event with no associated udev device.";
+    // The event may have been lost, e.g. to a netlink buffer overrun, so
+    // |block_devices_| can no longer be trusted.
+    block_devices_scanned_ = false;
     return false;
   }
 
@@ -311,6 +327,7 @@ bool DiskManager::GetDeviceEvents(DeviceEventList* events) {
   // |udev_monitor_| only monitors block, mmc, and scsi device changes, so
   // subsystem is either "block", "mmc", or "scsi".
   if (strcmp(subsystem, kBlockSubsystem) == 0) {
+    UpdateBlockDevices(dev, action);
     ProcessBlockDeviceEvents(dev, action, events);
   } else {
     // strcmp(subsystem, kMmcSubsystem) == 0 ||
@@ -327,11 +344,25 @@ bool DiskManager::GetDiskByDevicePath(const string& device_path,
   if (device_path.empty())
     return false;
 
-  bool disk_found = false;
-  EnumerateBlockDevices(base::Bind(&MatchDiskByPath, device_path,
-                                   base::Unretained(&disk_found),
-                                   base::Unretained(disk)));
-  return disk_found;
+  ScanBlockDevicesIfNeeded();
+
+  for (const auto& block_device : block_devices_) {
+    const string& sys_path = block_device.first;
+    const BlockDevicePaths& paths = block_device.second;
+    if (device_path != sys_path && device_path != paths.dev_path &&
+        device_path != paths.dev_file) {
+      continue;
+    }
+
+    udev_device* dev = udev_device_new_from_syspath(udev_, sys_path.c_str());
+    if (!dev)
+      return false;
+    if (disk)
+      *disk = UdevDevice(dev).ToDisk();
+    udev_device_unref(dev);
+    return true;
+  }
+  return false;
 }
 
 const Filesystem* DiskManager::GetFilesystem(
@@ -135,6 +135,19 @@ class DiskManager : public MountManager, public DeviceEventSourceInterface {
   void EnumerateBlockDevices(
       const base::Callback<bool(udev_device* dev)>& callback) const;
 
+  // Scans the block devices on the system into |block_devices_| unless that
+  // has already been done. From then on, |block_devices_| is kept up to date
+  // by UpdateBlockDevices() as udev events arrive.
+  void ScanBlockDevicesIfNeeded() const;
+
+  // An EnumerateBlockDevices callback that records the paths of |dev| in
+  // |block_devices_|. Always returns true to continue enumeration in
+  // EnumerateBlockDevices.
+  bool AddBlockDevice(udev_device* dev) const;
+
+  // Applies the udev |action| on the block device |dev| to |block_devices_|.
+  void UpdateBlockDevices(udev_device* dev, const char* action);
+
   // Determines one or more device/disk events from a udev block device change.
   void ProcessBlockDeviceEvents(udev_device* device,
                                 const char* action,
@@ -183,6 +196,20 @@ class DiskManager : public MountManager, public DeviceEventSourceInterface {
   // to a set of sysfs paths of the immediate children of the disk.
   std::map<std::string, std::set<std::string>> disks_detected_;
 
+  // Paths under which a block device can be looked up.
+  struct BlockDevicePaths {
+    std::string dev_path;
+    std::string dev_file;
+  };
+
+  // A mapping from the sysfs path of every block device on the system to its
+  // other paths. EnumerateDisks() and GetDiskByDevicePath() use it instead of
+  // rescanning all block devices on every call.
+  mutable std::map<std::string, BlockDevicePaths> block_devices_;
+
+  // Set to true once |block_devices_| has been populated.
+  mutable bool block_devices_scanned_;
+
   // A set of supported filesystems indexed by filesystem type.
   std::map<std::string, Filesystem> filesystems_;
 
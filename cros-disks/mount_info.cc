@@ -4,7 +4,11 @@
 
 #include "cros-disks/mount_info.h"
 
+#include <fcntl.h>
+#include <poll.h>
+
 #include <base/logging.h>
+#include <base/posix/eintr_wrapper.h>
 #include <base/strings/string_split.h>
 
 #include "cros-disks/file_reader.h"
@@ -15,6 +19,8 @@ using std::vector;
 
 namespace {
 
+const char kMountInfoPath[] = "/proc/self/mountinfo";
+
 bool IsOctalDigit(char digit) {
   return digit >= '0' && digit <= '7';
 }
@@ -30,7 +36,7 @@ struct MountPoint {
   string filesystem_type;
 };
 
-MountInfo::MountInfo() {}
+MountInfo::MountInfo() : up_to_date_(false) {}
 
 MountInfo::~MountInfo() {}
 
@@ -79,6 +85,7 @@ bool MountInfo::HasMountPath(const string& mount_path) const {
 }
 bool MountInfo::RetrieveFromFile(const string& path) {
   mount_points_.clear();
+  up_to_date_ = false;
 
   FileReader reader;
   if (!reader.Open(FilePath(path))) {
@@ -103,7 +110,36 @@ bool MountInfo::RetrieveFromFile(const string& path) {
 }
 
 bool MountInfo::RetrieveFromCurrentProcess() {
-  return RetrieveFromFile("/proc/self/mountinfo");
+  return RetrieveFromFile(kMountInfoPath);
+}
+
+bool MountInfo::RefreshFromCurrentProcess() {
+  if (!mount_info_fd_.is_valid()) {
+    // The kernel only reports changes made after the file was opened, so the
+    // mount table must be read once after opening it.
+    mount_info_fd_.reset(
+        HANDLE_EINTR(open(kMountInfoPath, O_RDONLY | O_CLOEXEC)));
+    up_to_date_ = false;
+    if (!mount_info_fd_.is_valid()) {
+      PLOG(WARNING) << "Failed to open '" << kMountInfoPath << "'";
+      return RetrieveFromCurrentProcess();
+    }
+  }
+
+  // Polling consumes the change notification, so it must happen before the
+  // mount table is read. A change made in between is reported by the next
+  // poll.
+  struct pollfd poll_fd = {mount_info_fd_.get(), POLLPRI, 0};
+  if (HANDLE_EINTR(poll(&poll_fd, 1, 0)) < 0) {
+    PLOG(WARNING) << "Failed to poll '" << kMountInfoPath << "'";
+    up_to_date_ = false;
+  } else if (poll_fd.revents & (POLLPRI | POLLERR)) {
+    up_to_date_ = false;
+  }
+
+  if (!up_to_date_)
+    up_to_date_ = RetrieveFromCurrentProcess();
+  return up_to_date_;
 }
 
 }  // namespace cros_disks
@@ -8,6 +8,7 @@
 #include <string>
 #include <vector>
 
+#include <base/files/scoped_file.h>
 #include <base/macros.h>
 #include <gtest/gtest_prod.h>
 
@@ -42,6 +43,12 @@ class MountInfo {
   // /proc/self/mountinfo. Returns true on success.
   bool RetrieveFromCurrentProcess();
 
+  // Same as RetrieveFromCurrentProcess(), but skips rereading
+  // /proc/self/mountinfo if the kernel has not reported a change to the mount
+  // table, through poll(POLLPRI), since the last successful call. Returns true
+  // on success.
+  bool RefreshFromCurrentProcess();
+
  private:
   // Converts a 3-character octal string into a decimal integer.
   // Returns -1 if the conversion fails.
@@ -50,6 +57,13 @@ class MountInfo {
   // A list of mount points gathered by the last call to RetrieveMountInfo().
   std::vector<MountPoint> mount_points_;
 
+  // An open /proc/self/mountinfo polled by RefreshFromCurrentProcess().
+  base::ScopedFD mount_info_fd_;
+
+  // Set to true if |mount_points_| reflects the mount table as of the last
+  // change reported on |mount_info_fd_|.
+  bool up_to_date_;
+
   FRIEND_TEST(MountInfoTest, ConvertOctalStringToInt);
 
   DISALLOW_COPY_AND_ASSIGN(MountInfo);
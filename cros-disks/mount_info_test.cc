@@ -105,4 +105,18 @@ TEST_F(MountInfoTest, RetrieveFromCurrentProcess) {
   EXPECT_TRUE(manager_.HasMountPath("/proc"));
 }
 
+TEST_F(MountInfoTest, RefreshFromCurrentProcess) {
+  EXPECT_TRUE(manager_.RefreshFromCurrentProcess());
+  EXPECT_TRUE(manager_.HasMountPath("/proc"));
+  EXPECT_TRUE(manager_.RefreshFromCurrentProcess());
+  EXPECT_TRUE(manager_.HasMountPath("/proc"));
+
+  // Mount points retrieved from another file are not mistaken for the
+  // current ones.
+  EXPECT_TRUE(manager_.RetrieveFromFile(mount_file_));
+  EXPECT_TRUE(manager_.HasMountPath("/media/Test 1"));
+  EXPECT_TRUE(manager_.RefreshFromCurrentProcess());
+  EXPECT_FALSE(manager_.HasMountPath("/media/Test 1"));
+}
+
 }  // namespace cros_disks
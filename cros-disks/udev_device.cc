@@ -11,6 +11,7 @@
 #include <sys/statvfs.h>
 
 #include <base/logging.h>
+#include <base/no_destructor.h>
 #include <base/sha1.h>
 #include <base/strings/string_number_conversions.h>
 #include <base/strings/string_split.h>
@@ -400,9 +401,11 @@ vector<string> UdevDevice::GetMountPaths() const {
 }
 
 vector<string> UdevDevice::GetMountPaths(const string& device_path) {
-  MountInfo mount_info;
-  if (mount_info.RetrieveFromCurrentProcess()) {
-    return mount_info.GetMountPaths(device_path);
+  // Listing disks asks for the mount paths of every disk, usually while the
+  // mount table stays unchanged, so only reread it after it has changed.
+  static base::NoDestructor<MountInfo> mount_info;
+  if (mount_info->RefreshFromCurrentProcess()) {
+    return mount_info->GetMountPaths(device_path);
   }
   return vector<string>();
 }
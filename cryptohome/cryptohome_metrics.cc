@@ -31,6 +31,8 @@ constexpr char kChecksumStatusHistogram[] = "Cryptohome.ChecksumStatus";
 constexpr char kCryptohomeTpmResultsHistogram[] = "Cryptohome.TpmResults";
 constexpr char kCryptohomeDeletedUserProfilesHistogram[] =
     "Cryptohome.DeletedUserProfiles";
+constexpr char kCryptohomeKeysetDecryptAttemptsHistogram[] =
+    "Cryptohome.KeysetDecryptAttempts";
 constexpr char kCryptohomeGCacheFreedDiskSpaceInMbHistogram[] =
     "Cryptohome.GCache.FreedDiskSpaceInMb";
 constexpr char kCryptohomeFreeDiskSpaceTotalTimeHistogram[] =
@@ -96,7 +98,7 @@ const TimerHistogramParams kTimerHistogramParams[cryptohome::kNumTimerTypes] = {
      2 * 60 * 1000, 50}
 };
 
-MetricsLibrary* g_metrics = NULL;
+MetricsLibraryInterface* g_metrics = NULL;
 chromeos_metrics::TimerReporter* g_timers[cryptohome::kNumTimerTypes] = {NULL};
 
 chromeos_metrics::TimerReporter* GetTimer(cryptohome::TimerType timer_type) {
@@ -133,6 +135,11 @@ void TearDownMetrics() {
   }
 }
 
+void OverrideMetricsLibraryForTesting(
+    MetricsLibraryInterface* metrics_library) {
+  g_metrics = metrics_library;
+}
+
 void ReportCryptohomeError(CryptohomeError error) {
   if (!g_metrics) {
     return;
@@ -227,6 +234,15 @@ void ReportDeletedUserProfiles(int user_profile_count) {
                        20 /* number of buckets */);
 }
 
+void ReportKeysetDecryptAttempts(int attempts) {
+  if (!g_metrics) {
+    return;
+  }
+  g_metrics->SendToUMA(kCryptohomeKeysetDecryptAttemptsHistogram, attempts,
+                       1 /* minimum */, 20 /* maximum */,
+                       20 /* number of buckets */);
+}
+
 void ReportFreeDiskSpaceTotalTime(int ms) {
   if (!g_metrics) {
     return;
@@ -12,6 +12,8 @@
 #include "cryptohome/tpm.h"
 #include "cryptohome/tpm_metrics.h"
 
+class MetricsLibrary;
+
 namespace cryptohome {
 
 // List of all the possible operation types. Used to construct the correct
@@ -212,6 +214,11 @@ void InitializeMetrics();
 // Cleans up and returns cryptohome metrics to an uninitialized state.
 void TearDownMetrics();
 
+// Sends all metrics to |metrics_library| instead, for testing. The library is
+// not owned. Passing NULL turns reporting off again.
+void OverrideMetricsLibraryForTesting(
+    MetricsLibraryInterface* metrics_library);
+
 // The |error| value is reported to the "Cryptohome.Errors" enum histogram.
 void ReportCryptohomeError(CryptohomeError error);
 
@@ -326,6 +333,11 @@ void ReportDircryptoMigrationFailedNoSpace(int initial_migration_free_space_mb,
 void ReportDircryptoMigrationFailedNoSpaceXattrSizeInBytes(
     int total_xattr_size_bytes);
 
+// Reports the number of keysets that had to be decrypted before
+// HomeDirs::GetValidKeyset() found a match to the
+// "Cryptohome.KeysetDecryptAttempts" histogram.
+void ReportKeysetDecryptAttempts(int attempts);
+
 // Initialization helper.
 class ScopedMetricsInitializer {
  public:
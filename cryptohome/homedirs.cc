@@ -52,6 +52,9 @@ const char kAndroidCacheInodeAttribute[] = "user.inode_cache";
 const char kAndroidCodeCacheInodeAttribute[] = "user.inode_code_cache";
 const char kTrackedDirectoryNameAttribute[] = "user.TrackedDirectoryName";
 const char kRemovableFileAttribute[] = "user.GCacheRemovable";
+// Set on the shadow directory of an unmounted cryptohome, contains the size
+// last computed by ComputeSize() as a decimal string.
+const char kCachedSizeAttribute[] = "user.CryptohomeSize";
 // Name of the vault directory which is used with eCryptfs cryptohome.
 const char kEcryptfsVaultDir[] = "vault";
 // Name of the mount directory.
@@ -237,7 +240,9 @@ int HomeDirs::DeleteUserProfiles() {
         base::Unretained(this)));
   }
 
-  // Delete old users using timestamp_cache_, the oldest first.
+  // Delete old users using timestamp_cache_, the oldest first. Victims are
+  // ranked by last activity rather than by size, and progress is measured
+  // with AmountOfFreeDiskSpace(), so no cryptohome tree is walked here.
   // Don't delete anyone if we don't know who the owner is.
   // For consumer devices, don't delete the device owner. Enterprise-enrolled
   // devices have no owner, so don't delete the last user.
@@ -350,10 +355,22 @@ bool HomeDirs::GetValidKeyset(const Credentials& creds,
     return false;
   }
 
+  // Users normally authenticate with the same key every time, so try the
+  // keyset that matched last time first. Each failed Decrypt() costs a full
+  // key derivation and possibly a TPM round trip.
+  auto last_valid = last_valid_key_index_.find(obfuscated);
+  if (last_valid != last_valid_key_index_.end()) {
+    auto it =
+        std::find(key_indices.begin(), key_indices.end(), last_valid->second);
+    if (it != key_indices.end())
+      std::rotate(key_indices.begin(), it, it + 1);
+  }
+
   SecureBlob passkey;
   creds.GetPasskey(&passkey);
 
   bool any_keyset_exists = false;
+  int decrypt_attempts = 0;
   Crypto::CryptoError last_crypto_error = Crypto::CE_NONE;
   for (int index : key_indices) {
     if (!vk->Load(GetVaultKeysetPath(obfuscated, index)))
@@ -370,7 +387,10 @@ bool HomeDirs::GetValidKeyset(const Credentials& creds,
     if (creds.key_data().label().empty() &&
         (vk->serialized().flags() & SerializedVaultKeyset::LE_CREDENTIAL))
       continue;
+    ++decrypt_attempts;
     if (vk->Decrypt(passkey, &last_crypto_error)) {
+      ReportKeysetDecryptAttempts(decrypt_attempts);
+      last_valid_key_index_[obfuscated] = index;
       if (key_index)
         *key_index = index;
       return true;
@@ -723,6 +743,7 @@ CryptohomeErrorCode HomeDirs::UpdateKeyset(
     }
   }
 
+  InvalidateCachedSize(obfuscated_username);
   if (!vk->Encrypt(passkey, obfuscated_username) ||
       !vk->Save(vk->source_file())) {
     LOG(ERROR) << "Failed to encrypt and write the updated keyset";
@@ -769,6 +790,8 @@ CryptohomeErrorCode HomeDirs::AddKeyset(
     return CRYPTOHOME_ERROR_AUTHORIZATION_KEY_DENIED;
   }
 
+  InvalidateCachedSize(obfuscated);
+
   // If the VaultKeyset doesn't have a reset seed, simply generate
   // one and re-encrypt before proceeding.
   if (!vk->serialized().has_wrapped_reset_seed()) {
@@ -904,6 +927,7 @@ bool HomeDirs::ForceRemoveKeyset(const std::string& obfuscated, int index) {
     // Since it doesn't exist, then we're done.
     return true;
   }
+  InvalidateCachedSize(obfuscated);
 
   // Try removing the LE credential data, if applicable. But, don't abort if we
   // fail. The leaf data will remain, but at least the SerializedVaultKeyset
@@ -933,6 +957,7 @@ bool HomeDirs::MoveKeyset(const std::string& obfuscated, int src, int dst) {
     return false;
   if (platform_->FileExists(dst_path))
     return false;
+  InvalidateCachedSize(obfuscated);
   // Grab the destination exclusively
   FILE* vk_file = platform_->OpenFile(dst_path, "wx");
   if (!vk_file)
@@ -1111,6 +1136,7 @@ bool HomeDirs::GetTrackedDirectoryForDirCrypto(
 }
 
 void HomeDirs::DeleteCacheCallback(const FilePath& user_dir) {
+  InvalidateCachedSize(user_dir.BaseName().value());
   FilePath cache;
   if (!GetTrackedDirectory(
           user_dir, FilePath(kUserHomeSuffix).Append(kCacheDir), &cache)) {
@@ -1122,6 +1148,7 @@ void HomeDirs::DeleteCacheCallback(const FilePath& user_dir) {
 }
 
 void HomeDirs::DeleteGCacheTmpCallback(const FilePath& user_dir) {
+  InvalidateCachedSize(user_dir.BaseName().value());
   // GCache dirs that can be completely removed on low space.
   const FilePath kRemovableGCacheDirs[] = {
       FilePath(kUserHomeSuffix)
@@ -1159,6 +1186,7 @@ void HomeDirs::DeleteGCacheTmpCallback(const FilePath& user_dir) {
 }
 
 void HomeDirs::DeleteAndroidCacheCallback(const FilePath& user_dir) {
+  InvalidateCachedSize(user_dir.BaseName().value());
   FilePath root;
   if (!GetTrackedDirectory(user_dir, FilePath(kRootHomeSuffix), &root)) {
     LOG(ERROR) << "Failed to locate the root directory.";
@@ -1295,6 +1323,7 @@ bool HomeDirs::GetSystemSalt(SecureBlob* blob) {
 bool HomeDirs::Remove(const std::string& username) {
   std::string obfuscated = BuildObfuscatedUsername(username, system_salt_);
   RemoveLECredentials(obfuscated);
+  last_valid_key_index_.erase(obfuscated);
 
   FilePath user_dir = shadow_root_.Append(obfuscated);
   FilePath user_path = brillo::cryptohome::home::GetUserPath(username);
@@ -1412,7 +1441,22 @@ int64_t HomeDirs::ComputeSize(const std::string& account_id) {
   FilePath user_dir = FilePath(shadow_root_).Append(obfuscated);
   FilePath user_path = brillo::cryptohome::home::GetUserPath(account_id);
   FilePath root_path = brillo::cryptohome::home::GetRootPath(account_id);
+
+  // An unmounted cryptohome only changes through FreeDiskSpace() and the
+  // keyset writes in this class, which all invalidate the cached size, so it
+  // can be reused until one of those happens or the next mount.
+  const bool mounted = platform_->IsDirectoryMounted(
+      brillo::cryptohome::home::GetHashedUserPath(obfuscated));
+  std::string cached_size;
   int64_t total_size = 0;
+  if (!mounted &&
+      platform_->GetExtendedFileAttributeAsString(
+          user_dir, kCachedSizeAttribute, &cached_size) &&
+      base::StringToInt64(cached_size, &total_size) && total_size >= 0) {
+    return total_size;
+  }
+
+  total_size = 0;
   int64_t size = platform_->ComputeDirectorySize(user_dir);
   if (size > 0) {
     total_size += size;
@@ -1425,9 +1469,24 @@ int64_t HomeDirs::ComputeSize(const std::string& account_id) {
   if (size > 0) {
     total_size += size;
   }
+
+  if (!mounted && platform_->DirectoryExists(user_dir)) {
+    cached_size = base::Int64ToString(total_size);
+    if (!platform_->SetExtendedFileAttribute(user_dir, kCachedSizeAttribute,
+                                             cached_size.data(),
+                                             cached_size.size())) {
+      LOG(WARNING) << "Failed to cache the size of " << user_dir.value();
+    }
+  }
   return total_size;
 }
 
+void HomeDirs::InvalidateCachedSize(const std::string& obfuscated_username) {
+  FilePath user_dir = shadow_root_.Append(obfuscated_username);
+  if (platform_->HasExtendedFileAttribute(user_dir, kCachedSizeAttribute))
+    platform_->RemoveExtendedFileAttribute(user_dir, kCachedSizeAttribute);
+}
+
 bool HomeDirs::Migrate(const Credentials& newcreds,
                        const SecureBlob& oldkey) {
   SecureBlob newkey;
@@ -1580,6 +1639,7 @@ void HomeDirs::ResetLECredentials(const Credentials& creds) {
     LOG(WARNING) << "No valid keysets on disk for " << obfuscated;
     return;
   }
+  InvalidateCachedSize(obfuscated);
 
   std::unique_ptr<VaultKeyset> vk_reset(
       vault_keyset_factory()->New(platform_, crypto_));
@@ -1609,6 +1669,7 @@ void HomeDirs::RemoveLECredentials(const std::string& obfuscated_username) {
     LOG(WARNING) << "No valid keysets on disk for " << obfuscated_username;
     return;
   }
+  InvalidateCachedSize(obfuscated_username);
 
   std::unique_ptr<VaultKeyset> vk_remove(
       vault_keyset_factory()->New(platform_, crypto_));
@@ -10,6 +10,7 @@
 
 #include <stdint.h>
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -120,9 +121,15 @@ class HomeDirs {
   virtual bool Rename(const std::string& account_id_from,
                       const std::string& account_id_to);
 
-  // Computes the size of cryptohome for the named user.
+  // Computes the size of cryptohome for the named user. The size of an
+  // unmounted cryptohome is remembered in an xattr on its shadow directory, so
+  // repeated queries don't walk the whole tree again.
   virtual int64_t ComputeSize(const std::string& account_id);
 
+  // Forgets the remembered size of the given user's cryptohome. Must be called
+  // before the cryptohome is modified, e.g. when it gets mounted.
+  void InvalidateCachedSize(const std::string& obfuscated_username);
+
   // Returns true if the supplied Credentials are a valid (username, passkey)
   // pair.
   virtual bool AreCredentialsValid(const Credentials& credentials);
@@ -377,6 +384,10 @@ class HomeDirs {
   VaultKeysetFactory* vault_keyset_factory_;
   brillo::SecureBlob system_salt_;
   chaps::TokenManagerClient chaps_client_;
+  // Index of the keyset that last passed GetValidKeyset(), per obfuscated
+  // user. Only used to order decryption attempts, so a stale entry merely
+  // costs the extra attempts it was meant to save.
+  std::map<std::string, int> last_valid_key_index_;
 
   // The container a not-shifted system UID in ARC++ container (AID_SYSTEM).
   static constexpr uid_t kAndroidSystemUid = 1000;
@@ -5,6 +5,7 @@
 #include "cryptohome/homedirs.h"
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <base/files/file_path.h>
@@ -17,8 +18,10 @@
 #include <chromeos/constants/cryptohome.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <metrics/metrics_library_mock.h>
 #include <policy/mock_device_policy.h>
 
+#include "cryptohome/cryptohome_metrics.h"
 #include "cryptohome/cryptolib.h"
 #include "cryptohome/make_tests.h"
 #include "cryptohome/mock_crypto.h"
@@ -308,6 +311,27 @@ TEST_P(HomeDirsTest, ComputeSize) {
             homedirs_.ComputeSize(kDefaultUsers[0].username));
 }
 
+TEST_P(HomeDirsTest, ComputeSizeUsesCachedSizeWhenUnmounted) {
+  FilePath base_path(test_helper_.users[0].base_path);
+  ASSERT_TRUE(base::CreateDirectory(base_path));
+
+  // The first query walks the tree and caches the result.
+  EXPECT_CALL(platform_, ComputeDirectorySize(_))
+    .WillOnce(Return(100))
+    .WillOnce(Return(20))
+    .WillOnce(Return(3));
+  EXPECT_CALL(platform_,
+              SetExtendedFileAttribute(base_path, "user.CryptohomeSize", _, 3))
+    .WillOnce(Return(true));
+  EXPECT_EQ(123, homedirs_.ComputeSize(kDefaultUsers[0].username));
+
+  // Subsequent queries are answered from the cache without walking the tree.
+  EXPECT_CALL(platform_, GetExtendedFileAttributeAsString(
+                             base_path, "user.CryptohomeSize", _))
+    .WillOnce(DoAll(SetArgPointee<2>(std::string("123")), Return(true)));
+  EXPECT_EQ(123, homedirs_.ComputeSize(kDefaultUsers[0].username));
+}
+
 TEST_P(HomeDirsTest, ComputeSizeWithNonexistentUser) {
   // If the specified user doesn't exist, there is no directory for the user, so
   // ComputeSize should return 0.
@@ -1490,6 +1514,47 @@ TEST_P(HomeDirsTest, BadDecryptTest) {
   ASSERT_FALSE(homedirs_.AreCredentialsValid(up));
 }
 
+TEST_P(HomeDirsTest, GetValidKeysetTriesLastMatchFirst) {
+  set_policy(false, "", false, "");
+  NiceMock<MetricsLibraryMock> metrics;
+  OverrideMetricsLibraryForTesting(&metrics);
+
+  const auto& user = test_helper_.users[1];
+  const FilePath keyset0 = user.base_path.Append("master.0");
+  const FilePath keyset1 = user.base_path.Append("master.1");
+  EXPECT_CALL(platform_, GetFileEnumerator(user.base_path, false, _))
+      .WillRepeatedly(InvokeWithoutArgs([this, keyset0, keyset1]() {
+        return CreateFileEnumerator({keyset0, keyset1});
+      }));
+
+  // Only the second keyset matches. The first lookup has to try both, the
+  // second one goes straight to the keyset that matched.
+  NiceMock<MockVaultKeyset> vk;
+  {
+    InSequence s;
+    EXPECT_CALL(vk, Load(keyset0)).WillOnce(Return(true));
+    EXPECT_CALL(vk, Decrypt(_, _)).WillOnce(Return(false));
+    EXPECT_CALL(vk, Load(keyset1)).WillOnce(Return(true));
+    EXPECT_CALL(vk, Decrypt(_, _)).WillOnce(Return(true));
+    EXPECT_CALL(metrics,
+                SendToUMA("Cryptohome.KeysetDecryptAttempts", 2, _, _, _));
+    EXPECT_CALL(vk, Load(keyset1)).WillOnce(Return(true));
+    EXPECT_CALL(vk, Decrypt(_, _)).WillOnce(Return(true));
+    EXPECT_CALL(metrics,
+                SendToUMA("Cryptohome.KeysetDecryptAttempts", 1, _, _, _));
+  }
+
+  UsernamePasskey up(user.username, user.passkey);
+  int key_index = -1;
+  EXPECT_TRUE(homedirs_.GetValidKeyset(up, &vk, &key_index, nullptr));
+  EXPECT_EQ(1, key_index);
+  key_index = -1;
+  EXPECT_TRUE(homedirs_.GetValidKeyset(up, &vk, &key_index, nullptr));
+  EXPECT_EQ(1, key_index);
+
+  OverrideMetricsLibraryForTesting(nullptr);
+}
+
 #define MAX_VKS 5
 class KeysetManagementTest : public HomeDirsTest {
  public:
@@ -2319,6 +2384,28 @@ TEST_P(KeysetManagementTest, ForceRemoveKeysetSuccess) {
   ASSERT_TRUE(homedirs_.ForceRemoveKeyset("a0b0c0", 0));
 }
 
+TEST_P(KeysetManagementTest, ForceRemoveKeysetInvalidatesCachedSize) {
+  KeysetSetUp();
+  EXPECT_CALL(platform_,
+      HasExtendedFileAttribute(
+        Property(&FilePath::value, EndsWith("a0b0c0")),
+        "user.CryptohomeSize"))
+    .WillOnce(Return(true));
+  EXPECT_CALL(platform_,
+      RemoveExtendedFileAttribute(
+        Property(&FilePath::value, EndsWith("a0b0c0")),
+        "user.CryptohomeSize"))
+    .WillOnce(Return(true));
+  EXPECT_CALL(platform_,
+      DeleteFile(
+        Property(&FilePath::value, EndsWith("master.0")), false))
+    .WillOnce(Return(true));
+  // There is only one call to VaultKeyset, so it gets the MockVaultKeyset
+  // with index 0.
+  EXPECT_CALL(*active_vks_[0], Load(_)).WillOnce(Return(true));
+  ASSERT_TRUE(homedirs_.ForceRemoveKeyset("a0b0c0", 0));
+}
+
 TEST_P(KeysetManagementTest, ForceRemoveKeysetMissingKeyset) {
   KeysetSetUp();
   // There is only one call to VaultKeyset, so it gets the MockVaultKeyset
@@ -579,6 +579,10 @@ bool Mount::MountCryptohomeInner(const Credentials& credentials,
     *mount_error = MOUNT_ERROR_FATAL;
     return false;
   }
+  // The size cached while the cryptohome was unmounted goes stale as soon as
+  // the user starts writing to it.
+  homedirs_->InvalidateCachedSize(obfuscated_username);
+
   if (should_mount_ecryptfs) {
     // Create vault_path/user as a passthrough directory, move all the
     // (encrypted) contents of vault_path into vault_path/user, create
@@ -4,6 +4,8 @@
 
 #include "cryptohome/persistent_lookup_table.h"
 
+#include <utility>
+
 #include <base/files/file_util.h>
 #include <base/strings/string_number_conversions.h>
 #include <base/strings/string_split.h>
@@ -27,8 +29,13 @@ PersistentLookupTable::PersistentLookupTable(Platform* platform,
   CHECK(platform_);
 }
 
+constexpr size_t PersistentLookupTable::kMaxCachedValues;
+
 PLTError PersistentLookupTable::GetValue(const uint64_t key,
                                          std::vector<uint8_t>* value) {
+  if (GetCachedValue(key, value))
+    return PLT_SUCCESS;
+
   uint32_t latest_version = FindLatestVersion(key);
 
   if (latest_version == 0) {
@@ -50,6 +57,7 @@ PLTError PersistentLookupTable::GetValue(const uint64_t key,
     return PLT_KEY_NOT_FOUND;
   }
 
+  CacheValue(key, *value);
   return PLT_SUCCESS;
 }
 
@@ -73,13 +81,18 @@ PLTError PersistentLookupTable::StoreValue(
 
   if (!platform_->WriteFileAtomic(new_file, new_val, 0644)) {
     LOG(ERROR) << "Failed to create disk entry for file: " << new_file.value();
+    EvictCachedValue(key);
     return PLT_STORAGE_ERROR;
   }
 
+  if (index_loaded_)
+    latest_versions_[key] = new_version;
+  CacheValue(key, new_val);
   return PLT_SUCCESS;
 }
 
 PLTError PersistentLookupTable::RemoveKey(const uint64_t key) {
+  EvictCachedValue(key);
   uint32_t latest_version = FindLatestVersion(key);
 
   if (latest_version != 0) {
@@ -100,6 +113,16 @@ PLTError PersistentLookupTable::RemoveKey(const uint64_t key) {
 
   // Delete the entire directory anyway.
   DeleteOldKeyVersions(key, 0);
+
+  if (index_loaded_) {
+    // If the directory couldn't be deleted, the deletion marker is now the
+    // latest version on disk, which is what a rescan on the next boot sees.
+    base::FilePath key_dir = table_dir_.Append(std::to_string(key));
+    if (platform_->DirectoryExists(key_dir))
+      latest_versions_[key] = ScanLatestVersion(key);
+    else
+      latest_versions_.erase(key);
+  }
   return PLT_SUCCESS;
 }
 
@@ -108,6 +131,14 @@ bool PersistentLookupTable::KeyExists(const uint64_t key) {
 }
 
 void PersistentLookupTable::GetUsedKeys(std::vector<uint64_t>* key_list) {
+  if (index_loaded_) {
+    for (const auto& entry : latest_versions_) {
+      if (entry.second != 0)
+        key_list->push_back(entry.first);
+    }
+    return;
+  }
+
   // Go through all key directories, and if there are valid key entries,
   // add it to the list.
   base::FileEnumerator file(table_dir_, false,
@@ -126,6 +157,11 @@ void PersistentLookupTable::GetUsedKeys(std::vector<uint64_t>* key_list) {
 }
 
 bool PersistentLookupTable::InitOnBoot() {
+  index_loaded_ = false;
+  latest_versions_.clear();
+  value_cache_.clear();
+  value_cache_lru_.clear();
+
   if (!platform_->DirectoryExists(table_dir_)) {
     VLOG(1) << "Lookup table dir not found, have to create it.";
     if (!platform_->CreateDirectory(table_dir_)) {
@@ -143,14 +179,25 @@ bool PersistentLookupTable::InitOnBoot() {
         LOG(WARNING) << "Can't parse directory, skipping: " << cur_dir.value();
         continue;
       }
-      uint32_t version = FindLatestVersion(key);
+      uint32_t version = ScanLatestVersion(key);
       DeleteOldKeyVersions(key, version);
+      if (version != 0)
+        latest_versions_[key] = version;
     }
   }
+  index_loaded_ = true;
   return true;
 }
 
 uint32_t PersistentLookupTable::FindLatestVersion(const uint64_t key) {
+  if (!index_loaded_)
+    return ScanLatestVersion(key);
+
+  auto it = latest_versions_.find(key);
+  return it == latest_versions_.end() ? 0 : it->second;
+}
+
+uint32_t PersistentLookupTable::ScanLatestVersion(const uint64_t key) {
   base::FilePath key_dir = table_dir_.Append(std::to_string(key));
   if (!platform_->DirectoryExists(key_dir)) {
     // No directory with this key, so return 0;
@@ -215,4 +262,36 @@ void PersistentLookupTable::DeleteOldKeyVersions(const uint64_t key,
   }
 }
 
+bool PersistentLookupTable::GetCachedValue(const uint64_t key,
+                                           std::vector<uint8_t>* value) {
+  auto it = value_cache_.find(key);
+  if (it == value_cache_.end())
+    return false;
+
+  value_cache_lru_.splice(value_cache_lru_.begin(), value_cache_lru_,
+                          it->second.second);
+  *value = it->second.first;
+  return true;
+}
+
+void PersistentLookupTable::CacheValue(const uint64_t key,
+                                       const std::vector<uint8_t>& value) {
+  EvictCachedValue(key);
+  if (value_cache_.size() >= kMaxCachedValues) {
+    value_cache_.erase(value_cache_lru_.back());
+    value_cache_lru_.pop_back();
+  }
+  value_cache_lru_.push_front(key);
+  value_cache_[key] = std::make_pair(value, value_cache_lru_.begin());
+}
+
+void PersistentLookupTable::EvictCachedValue(const uint64_t key) {
+  auto it = value_cache_.find(key);
+  if (it == value_cache_.end())
+    return;
+
+  value_cache_lru_.erase(it->second.second);
+  value_cache_.erase(it);
+}
+
 }  // namespace cryptohome
@@ -4,6 +4,7 @@
 #ifndef CRYPTOHOME_PERSISTENT_LOOKUP_TABLE_H_
 #define CRYPTOHOME_PERSISTENT_LOOKUP_TABLE_H_
 
+#include <list>
 #include <map>
 #include <string>
 #include <utility>
@@ -62,6 +63,12 @@ enum PLTError {
 // NOTE: An empty value file is used as a marker that a key has been removed,
 // and marked for deletion. It is forbidden to store key values which are
 // empty.
+//
+// After InitOnBoot() the latest version of every key is kept in memory, so
+// lookups and updates don't need to enumerate the key directory, and the most
+// recently used values are cached. The on-disk layout and its crash
+// consistency guarantees are unchanged; the in-memory state is only ever
+// updated after the corresponding disk operation succeeded.
 class PersistentLookupTable {
  public:
   PersistentLookupTable(Platform* platform, base::FilePath basedir);
@@ -122,7 +129,11 @@ class PersistentLookupTable {
   FRIEND_TEST(PersistentLookupTableTest, CreateDirStoreValues);
   FRIEND_TEST(PersistentLookupTableTest, RestoreTable);
 
-  // Finds the latest verified version number for a key.
+  // Maximum number of values kept in |value_cache_|.
+  static constexpr size_t kMaxCachedValues = 32;
+
+  // Finds the latest verified version number for a key, using the in-memory
+  // index once it has been built by InitOnBoot().
   // Returns a non-zero version number on success, 0 otherwise.
   // NOTE: We assume that the minimum version number is 1.
   // A return value of 0 may mean either:
@@ -130,15 +141,42 @@ class PersistentLookupTable {
   // - The directory exists, but no valid file exists inside it.
   uint32_t FindLatestVersion(const uint64_t key);
 
+  // Same as FindLatestVersion(), but always enumerates the key directory.
+  uint32_t ScanLatestVersion(const uint64_t key);
+
   // Delete all the versions of a key, except the version specified in
   // |version_to_save|. If |version_to_save| is 0, remove the entire key
   // directory.
   void DeleteOldKeyVersions(const uint64_t key, uint32_t version_to_save);
 
+  // Returns true and copies the cached value of |key| into |value| if it is
+  // in |value_cache_|, marking it as most recently used.
+  bool GetCachedValue(const uint64_t key, std::vector<uint8_t>* value);
+
+  // Adds or replaces the cached value of |key|, evicting the least recently
+  // used value if the cache is full.
+  void CacheValue(const uint64_t key, const std::vector<uint8_t>& value);
+
+  // Drops |key| from |value_cache_|, if present.
+  void EvictCachedValue(const uint64_t key);
+
   Platform* platform_;
 
   // Convenience member to store the lookup table directory path.
   base::FilePath table_dir_;
+
+  // Whether |latest_versions_| has been built and can be trusted.
+  bool index_loaded_ = false;
+
+  // Latest version number of every key directory present on disk.
+  std::map<uint64_t, uint32_t> latest_versions_;
+
+  // Recently used values, with the most recently used key at the front of
+  // |value_cache_lru_|.
+  std::map<uint64_t,
+           std::pair<std::vector<uint8_t>, std::list<uint64_t>::iterator>>
+      value_cache_;
+  std::list<uint64_t> value_cache_lru_;
 };
 
 }  // namespace cryptohome
@@ -173,4 +173,47 @@ TEST(PersistentLookupTableTest, GetUsedKeys) {
             std::set<uint64_t>(key_list.begin(), key_list.end()));
 }
 
+// Tests that values are still read correctly once there are more keys than
+// values kept in memory, both before and after restoring the table.
+TEST(PersistentLookupTableTest, MoreKeysThanCachedValues) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  const uint64_t kNumKeys = 100;
+  std::unique_ptr<Platform> platform(new Platform());
+  std::unique_ptr<PersistentLookupTable> lookup_table =
+      std::make_unique<PersistentLookupTable>(platform.get(),
+                                              temp_dir.GetPath());
+  lookup_table->InitOnBoot();
+
+  for (uint64_t key = 0; key < kNumKeys; ++key) {
+    std::vector<uint8_t> value = {static_cast<uint8_t>(key), 0x01};
+    ASSERT_EQ(PLT_SUCCESS, lookup_table->StoreValue(key, value));
+    value[1] = 0x02;
+    ASSERT_EQ(PLT_SUCCESS, lookup_table->StoreValue(key, value));
+  }
+
+  std::vector<uint8_t> result;
+  for (uint64_t key = 0; key < kNumKeys; ++key) {
+    result.clear();
+    EXPECT_EQ(PLT_SUCCESS, lookup_table->GetValue(key, &result));
+    EXPECT_EQ(std::vector<uint8_t>({static_cast<uint8_t>(key), 0x02}), result);
+  }
+
+  lookup_table.reset();
+  lookup_table = std::make_unique<PersistentLookupTable>(platform.get(),
+                                                         temp_dir.GetPath());
+  lookup_table->InitOnBoot();
+
+  std::vector<uint64_t> key_list;
+  lookup_table->GetUsedKeys(&key_list);
+  EXPECT_EQ(kNumKeys, key_list.size());
+  for (uint64_t key = kNumKeys; key > 0; --key) {
+    result.clear();
+    EXPECT_EQ(PLT_SUCCESS, lookup_table->GetValue(key - 1, &result));
+    EXPECT_EQ(std::vector<uint8_t>({static_cast<uint8_t>(key - 1), 0x02}),
+              result);
+  }
+}
+
 }  // namespace cryptohome
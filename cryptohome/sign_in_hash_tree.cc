@@ -5,12 +5,12 @@
 #include "cryptohome/sign_in_hash_tree.h"
 
 #include <fcntl.h>
+#include <openssl/sha.h>
 
 #include <algorithm>
 #include <utility>
 
 #include <base/files/file_util.h>
-#include <brillo/secure_blob.h>
 
 #include "cryptohome/cryptolib.h"
 
@@ -108,7 +108,15 @@ void SignInHashTree::GenerateAndStoreHashCache() {
 }
 
 void SignInHashTree::GenerateInnerHashArray() {
-  CalculateHash(Label(0, 0, bits_per_level_));
+  // Walk the tree bottom-up, one level at a time, so every inner node is
+  // hashed exactly once straight from its children's contiguous hashes.
+  for (uint32_t length = leaf_length_; length > 0;) {
+    length -= bits_per_level_;
+    uint64_t num_nodes = 1ULL << length;
+    for (uint64_t value = 0; value < num_nodes; value++)
+      UpdateInnerHash(Label(value, length, bits_per_level_));
+  }
+  inner_hash_array_valid_ = true;
 }
 
 bool SignInHashTree::StoreLabel(const Label& label,
@@ -140,6 +148,9 @@ bool SignInHashTree::StoreLabel(const Label& label,
     UpdateLeafCache(label.value(), hmac.data(), hmac.size());
   } else {
     UpdateInnerHashArray(label.cache_index(), hmac.data(), hmac.size());
+    // An inner hash that was set directly no longer matches the leaves, so
+    // the next GetRootHash() has to recompute the array.
+    inner_hash_array_valid_ = false;
   }
 
   UpdateHashCacheLabelPath(label);
@@ -237,53 +248,37 @@ SignInHashTree::Label SignInHashTree::GetFreeLabel() {
 }
 
 void SignInHashTree::GetRootHash(std::vector<uint8_t>* root_hash) {
-  GenerateInnerHashArray();
+  if (!inner_hash_array_valid_)
+    GenerateInnerHashArray();
   root_hash->assign(inner_hash_array_[0], inner_hash_array_[0] + kHashSize);
 }
 
-std::vector<uint8_t> SignInHashTree::CalculateHash(const Label& label) {
-  std::vector<uint8_t> ret_val;
-  if (IsLeafLabel(label)) {
-    ret_val.assign(leaf_cache_array_[label.value()],
-                   leaf_cache_array_[label.value()] + kHashSize);
-    return ret_val;
-  }
-
-  // Join all the child hashes / HMACs together, and hash the result.
-  std::vector<uint8_t> input_buffer;
-  for (uint64_t i = 0; i < fan_out_; i++) {
-    Label child_label = label.Extend(i);
-    std::vector<uint8_t> child_hash = CalculateHash(child_label);
-    input_buffer.insert(input_buffer.end(), child_hash.begin(),
-                        child_hash.end());
+void SignInHashTree::UpdateInnerHash(const Label& label) {
+  // The children of an inner node have consecutive values, so their hashes
+  // are stored next to each other in either the |leaf_cache_array_| or the
+  // |inner_hash_array_| and can be hashed without being copied.
+  Label first_child = label.Extend(0);
+  const uint8_t* children_hashes;
+  if (IsLeafLabel(first_child)) {
+    CHECK_LE((first_child.value() + fan_out_) * kHashSize,
+             leaf_cache_.length());
+    children_hashes = leaf_cache_array_[first_child.value()];
+  } else {
+    CHECK_LE((first_child.cache_index() + fan_out_) * kHashSize,
+             inner_hash_vector_.size());
+    children_hashes = inner_hash_array_[first_child.cache_index()];
   }
-  brillo::SecureBlob result_hash = CryptoLib::Sha256(input_buffer);
-  ret_val.assign(result_hash.begin(), result_hash.end());
 
-  // Update the hash cache with the new value.
-  UpdateInnerHashArray(label.cache_index(), ret_val.data(), ret_val.size());
-  return ret_val;
+  uint8_t result_hash[kHashSize];
+  SHA256(children_hashes, fan_out_ * kHashSize, result_hash);
+  UpdateInnerHashArray(label.cache_index(), result_hash, kHashSize);
 }
 
 void SignInHashTree::UpdateHashCacheLabelPath(const Label& label) {
   Label cur_label = label;
   while (!cur_label.is_root()) {
     Label parent = cur_label.GetParent();
-    std::vector<uint8_t> input_buffer;
-    for (uint64_t i = 0; i < fan_out_; i++) {
-      Label child_label = parent.Extend(i);
-      uint8_t* array_address;
-      if (IsLeafLabel(child_label)) {
-        array_address = leaf_cache_array_[child_label.value()];
-      } else {
-        array_address = inner_hash_array_[child_label.cache_index()];
-      }
-      input_buffer.insert(input_buffer.end(), array_address,
-                          array_address + kHashSize);
-    }
-    brillo::SecureBlob result_hash = CryptoLib::Sha256(input_buffer);
-    UpdateInnerHashArray(parent.cache_index(), result_hash.data(),
-                         result_hash.size());
+    UpdateInnerHash(parent);
     cur_label = parent;
   }
 }
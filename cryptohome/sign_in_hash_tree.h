@@ -62,6 +62,9 @@ const char kLeafCacheFileName[] = "leafcache";
 //   operation after a reboot. When a SignInHashTree object is created, the
 //   InnerHashArray will consist of an all-zero array. This can be used to
 //   determine whether the InnerHashArray has been initialized or not.
+//   Once generated, it is kept up to date by recomputing only the path from
+//   an updated leaf to the root, so it is not regenerated again unless an
+//   inner hash is stored directly.
 //
 // Once the HashCache is generated, we can index into the file or array to find
 // the relevant node's hash. NOTE: The HashCache is considered to be completely
@@ -194,8 +197,8 @@ class SignInHashTree {
   void GenerateAndStoreHashCache();
 
   // Compute all the inner hashes of the hash tree (i.e all levels of the hash
-  // tree except for the leaf level). This function calls CalculateHash() on the
-  // root hash.
+  // tree except for the leaf level), level by level starting from the parents
+  // of the leaves.
   void GenerateInnerHashArray();
 
   // Store the credential data for label |label| in the Hash Tree.
@@ -269,18 +272,14 @@ class SignInHashTree {
   Label GetFreeLabel();
 
   // Fills the current root hash from |inner_hash_array_| into
-  // |root_hash|. Before that, it regenerates the entire |inner_hash_array_|.
+  // |root_hash|. Before that, it regenerates the entire |inner_hash_array_|
+  // if it isn't known to be consistent with the |leaf_cache_|.
   void GetRootHash(std::vector<uint8_t>* root_hash);
 
  private:
-  // Recursive function which is used to calculate the hashes for the hash tree,
-  // starting node |label|. The resultant hash is returned.
-  // This function assumes that the leaf MAC values have already been updated
-  // in the |leaf_cache_|.
-  //
-  // In addition to calculating the hash for |label|, this function will
-  // also update the |inner_hash_array_| with the new value.
-  std::vector<uint8_t> CalculateHash(const Label& label);
+  // Recalculates the hash of the inner node |label| from the hashes of its
+  // children, and stores it in the |inner_hash_array_|.
+  void UpdateInnerHash(const Label& label);
 
   // Helper function to determine whether a Label corresponds to a leaf
   // node of the hash tree.
@@ -321,6 +320,9 @@ class SignInHashTree {
   std::vector<uint8_t> inner_hash_vector_;
   // Pointer to the |inner_hash_vector_| data.
   uint8_t (*inner_hash_array_)[kHashSize];
+  // Whether |inner_hash_array_| matches the hashes computed from the
+  // |leaf_cache_|.
+  bool inner_hash_array_valid_ = false;
 
   // This is used to actually store and retrieve data from the backing disk
   // storage.
@@ -220,4 +220,56 @@ TEST(SignInHashTreeUnitTest, UpdateHashCacheOnInsertRemove) {
   EXPECT_EQ(kRootHash14_4_1, returned_hash);
 }
 
+// Test that directly overwriting an inner hash doesn't leak into the root
+// hash: GetRootHash() must recompute the inner hashes from the leaves.
+TEST(SignInHashTreeUnitTest, GetRootHashAfterInnerLabelUpdate) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  SignInHashTree tree(4, 1, temp_dir.GetPath());
+  tree.GenerateAndStoreHashCache();
+
+  std::vector<uint8_t> root_hash;
+  tree.GetRootHash(&root_hash);
+  EXPECT_EQ(kRootHash4_2, root_hash);
+
+  std::vector<uint8_t> cred_data;
+  ASSERT_TRUE(tree.StoreLabel(SignInHashTree::Label(5, 3, 1), kSampleHash1,
+                              cred_data, false));
+  root_hash.clear();
+  tree.GetRootHash(&root_hash);
+  EXPECT_EQ(kRootHash4_2, root_hash);
+}
+
+// Test that a leaf update following a direct inner hash update still yields
+// the root hash of a tree built from the leaves alone, i.e. the leaf update
+// doesn't make the overwritten inner hash look consistent again.
+TEST(SignInHashTreeUnitTest, GetRootHashAfterInnerThenLeafLabelUpdate) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  SignInHashTree tree(4, 1, temp_dir.GetPath());
+  tree.GenerateAndStoreHashCache();
+
+  std::vector<uint8_t> cred_data;
+  ASSERT_TRUE(tree.StoreLabel(SignInHashTree::Label(5, 3, 1), kSampleHash1,
+                              cred_data, false));
+  ASSERT_TRUE(tree.StoreLabel(SignInHashTree::Label(9, 4, 1), kSampleHash1,
+                              kSampleCredData1, false));
+  std::vector<uint8_t> root_hash;
+  tree.GetRootHash(&root_hash);
+
+  base::ScopedTempDir fresh_temp_dir;
+  ASSERT_TRUE(fresh_temp_dir.CreateUniqueTempDir());
+  SignInHashTree fresh_tree(4, 1, fresh_temp_dir.GetPath());
+  fresh_tree.GenerateAndStoreHashCache();
+  ASSERT_TRUE(fresh_tree.StoreLabel(SignInHashTree::Label(9, 4, 1),
+                                    kSampleHash1, kSampleCredData1, false));
+  std::vector<uint8_t> fresh_root_hash;
+  fresh_tree.GetRootHash(&fresh_root_hash);
+
+  EXPECT_NE(kRootHash4_2, fresh_root_hash);
+  EXPECT_EQ(fresh_root_hash, root_hash);
+}
+
 }  // namespace cryptohome
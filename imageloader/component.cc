@@ -7,6 +7,7 @@
 #include <fcntl.h>
 
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -142,6 +143,13 @@ Component::Component(const base::FilePath& component_dir, int key_number)
 
 std::unique_ptr<Component> Component::Create(
     const base::FilePath& component_dir, const Keys& public_keys) {
+  return Create(component_dir, public_keys, nullptr);
+}
+
+std::unique_ptr<Component> Component::Create(
+    const base::FilePath& component_dir,
+    const Keys& public_keys,
+    ManifestCache* manifest_cache) {
   base::FilePath signature_path;
   size_t key_number;
   if (!GetSignaturePath(component_dir, &signature_path, &key_number)) {
@@ -155,26 +163,26 @@ std::unique_ptr<Component> Component::Create(
 
   std::unique_ptr<Component> component(
       new Component(component_dir, key_number));
-  if (!component->LoadManifest(public_keys[key_number - 1]))
+  if (!component->LoadManifest(public_keys[key_number - 1], manifest_cache))
     return nullptr;
   return component;
 }
 
 const Manifest& Component::manifest() {
-  return manifest_;
+  return *manifest_;
 }
 
 bool Component::Mount(HelperProcessProxy* mounter,
                       const base::FilePath& dest_dir) {
   // Read the table in and verify the hash.
   std::string table;
-  if (!GetAndVerifyTable(GetTablePath(component_dir_), manifest_.table_sha256(),
-                         &table)) {
+  if (!GetAndVerifyTable(GetTablePath(component_dir_),
+                         manifest_->table_sha256(), &table)) {
     LOG(ERROR) << "Could not read and verify dm-verity table.";
     return false;
   }
 
-  base::FilePath image_path(GetImagePath(component_dir_, manifest_.fs_type()));
+  base::FilePath image_path(GetImagePath(component_dir_, manifest_->fs_type()));
   base::File image(image_path, base::File::FLAG_OPEN | base::File::FLAG_READ);
   if (!image.IsValid()) {
     LOG(ERROR) << "Could not open image file.";
@@ -183,10 +191,11 @@ bool Component::Mount(HelperProcessProxy* mounter,
   base::ScopedFD image_fd(image.TakePlatformFile());
 
   return mounter->SendMountCommand(image_fd.get(), dest_dir.value(),
-                                   manifest_.fs_type(), table);
+                                   manifest_->fs_type(), table);
 }
 
-bool Component::LoadManifest(const std::vector<uint8_t>& public_key) {
+bool Component::LoadManifest(const std::vector<uint8_t>& public_key,
+                             ManifestCache* manifest_cache) {
   if (!base::ReadFileToStringWithMaxSize(GetManifestPath(component_dir_),
                                          &manifest_raw_, kMaximumFilesize)) {
     LOG(ERROR) << "Could not read manifest file.";
@@ -199,6 +208,13 @@ bool Component::LoadManifest(const std::vector<uint8_t>& public_key) {
     return false;
   }
 
+  if (manifest_cache) {
+    manifest_ =
+        manifest_cache->Lookup(public_key, manifest_raw_, manifest_sig_);
+    if (manifest_)
+      return true;
+  }
+
   crypto::SignatureVerifier verifier;
 
   if (!verifier.VerifyInit(
@@ -217,7 +233,14 @@ bool Component::LoadManifest(const std::vector<uint8_t>& public_key) {
     LOG(ERROR) << "Manifest failed signature verification.";
     return false;
   }
-  return manifest_.ParseManifest(manifest_raw_);
+  auto manifest = std::make_shared<Manifest>();
+  if (!manifest->ParseManifest(manifest_raw_))
+    return false;
+  manifest_ = std::move(manifest);
+
+  if (manifest_cache)
+    manifest_cache->Insert(public_key, manifest_raw_, manifest_sig_, manifest_);
+  return true;
 }
 
 bool Component::CopyTo(const base::FilePath& dest_dir) {
@@ -230,14 +253,14 @@ bool Component::CopyTo(const base::FilePath& dest_dir) {
 
   base::FilePath table_src(GetTablePath(component_dir_));
   base::FilePath table_dest(GetTablePath(dest_dir));
-  if (!CopyComponentFile(table_src, table_dest, manifest_.table_sha256())) {
+  if (!CopyComponentFile(table_src, table_dest, manifest_->table_sha256())) {
     LOG(ERROR) << "Could not copy table file.";
     return false;
   }
 
-  base::FilePath image_src(GetImagePath(component_dir_, manifest_.fs_type()));
-  base::FilePath image_dest(GetImagePath(dest_dir, manifest_.fs_type()));
-  if (!CopyComponentFile(image_src, image_dest, manifest_.image_sha256())) {
+  base::FilePath image_src(GetImagePath(component_dir_, manifest_->fs_type()));
+  base::FilePath image_dest(GetImagePath(dest_dir, manifest_->fs_type()));
+  if (!CopyComponentFile(image_src, image_dest, manifest_->image_sha256())) {
     LOG(ERROR) << "Could not copy image file.";
     return false;
   }
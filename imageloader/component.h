@@ -29,6 +29,7 @@
 #include "imageloader/helper_process_proxy.h"
 #include "imageloader/imageloader_impl.h"
 #include "imageloader/manifest.h"
+#include "imageloader/manifest_cache.h"
 
 namespace imageloader {
 
@@ -45,6 +46,12 @@ class Component {
   // fails.
   static std::unique_ptr<Component> Create(const base::FilePath& component_dir,
                                            const Keys& public_keys);
+  // Same as above, but skips signature verification and parsing when
+  // |manifest_cache| already holds a manifest verified from identical bytes.
+  // Newly verified manifests are added to |manifest_cache|.
+  static std::unique_ptr<Component> Create(const base::FilePath& component_dir,
+                                           const Keys& public_keys,
+                                           ManifestCache* manifest_cache);
 
   // Copies the component into |dest_dir|. |dest_dir| must already exist. In
   // order to be robust against files being modified on disk, this function
@@ -66,8 +73,10 @@ class Component {
   Component(const base::FilePath& component_dir, int key_number);
 
   // Loads and verifies the manfiest. Returns false on failure. |public_key| is
-  // the public key used to check the manifest signature.
-  bool LoadManifest(const std::vector<uint8_t>& public_key);
+  // the public key used to check the manifest signature. |manifest_cache| may
+  // be null.
+  bool LoadManifest(const std::vector<uint8_t>& public_key,
+                    ManifestCache* manifest_cache);
   bool CopyComponentFile(const base::FilePath& src,
                          const base::FilePath& dest,
                          const std::vector<uint8_t>& expected_hash);
@@ -89,7 +98,7 @@ class Component {
   size_t key_number_;
   std::string manifest_raw_;
   std::string manifest_sig_;
-  Manifest manifest_;
+  std::shared_ptr<const Manifest> manifest_;
 
   DISALLOW_COPY_AND_ASSIGN(Component);
 };
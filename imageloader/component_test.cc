@@ -21,6 +21,7 @@
 #include <gtest/gtest.h>
 
 #include "imageloader/imageloader_impl.h"
+#include "imageloader/manifest_cache.h"
 #include "imageloader/mock_helper_process_proxy.h"
 #include "imageloader/test_utilities.h"
 
@@ -138,6 +139,40 @@ TEST_F(ComponentTest, InitComponentAndCheckManifest) {
             component->manifest().table_sha256());
 }
 
+TEST_F(ComponentTest, InitComponentUsesManifestCache) {
+  ManifestCache cache;
+  std::unique_ptr<Component> component =
+      Component::Create(GetTestComponentPath(), keys_, &cache);
+  ASSERT_NE(nullptr, component);
+  EXPECT_EQ(1u, cache.size());
+
+  // The second component is served from the cache and shares the manifest.
+  std::unique_ptr<Component> cached_component =
+      Component::Create(GetTestComponentPath(), keys_, &cache);
+  ASSERT_NE(nullptr, cached_component);
+  EXPECT_EQ(1u, cache.size());
+  EXPECT_EQ(&component->manifest(), &cached_component->manifest());
+  EXPECT_EQ(kTestDataVersion, cached_component->manifest().version());
+}
+
+TEST_F(ComponentTest, ManifestCacheMissesOnModifiedSignature) {
+  ManifestCache cache;
+  std::unique_ptr<Component> component =
+      Component::Create(GetTestComponentPath(), keys_, &cache);
+  ASSERT_NE(nullptr, component);
+
+  base::FilePath component_dir = temp_dir_.Append("cached-component");
+  ASSERT_TRUE(base::CreateDirectory(component_dir));
+  ASSERT_TRUE(base::SetPosixFilePermissions(component_dir, kComponentDirPerms));
+  ASSERT_TRUE(component->CopyTo(component_dir));
+
+  const char data[] = "c";
+  ASSERT_TRUE(base::AppendToFile(component_dir.Append("imageloader.sig.1"),
+                                 data, sizeof(data)));
+  EXPECT_EQ(nullptr, Component::Create(component_dir, keys_, &cache));
+  EXPECT_EQ(1u, cache.size());
+}
+
 TEST_F(ComponentTest, TestCopyAndMountComponentExt4) {
   std::unique_ptr<Component> component =
       Component::Create(GetTestDataPath("ext4_component"), keys_);
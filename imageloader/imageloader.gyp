@@ -59,6 +59,8 @@
         'imageloader_impl.cc',
         'manifest.cc',
         'manifest.h',
+        'manifest_cache.cc',
+        'manifest_cache.h',
         'verity_mounter.cc',
         'verity_mounter.h',
         'verity_mounter_impl.cc',
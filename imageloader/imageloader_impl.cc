@@ -92,7 +92,7 @@ bool ImageLoaderImpl::LoadComponent(const std::string& name,
   }
 
   std::unique_ptr<Component> component =
-      Component::Create(component_path, config_.keys);
+      Component::Create(component_path, config_.keys, &manifest_cache_);
   if (!component) {
     LOG(ERROR) << "Failed to initialize component: " << name;
     return false;
@@ -138,7 +138,7 @@ std::string ImageLoaderImpl::LoadComponentAtPath(
   }
 
   std::unique_ptr<Component> component =
-      Component::Create(component_path, config_.keys);
+      Component::Create(component_path, config_.keys, &manifest_cache_);
   if (!component) {
     LOG(ERROR) << "Failed to initialize component: " << name;
     return kBadResult;
@@ -196,7 +196,7 @@ bool ImageLoaderImpl::RemoveComponentAtPath(
 
   // Check if component is removable.
   std::unique_ptr<Component> component =
-      Component::Create(component_path, config_.keys);
+      Component::Create(component_path, config_.keys, &manifest_cache_);
   if (!component) {
     LOG(ERROR) << "Failed to initialize component: " << name;
     return false;
@@ -261,8 +261,9 @@ bool ImageLoaderImpl::RegisterComponent(
     }
   }
 
-  std::unique_ptr<Component> component = Component::Create(
-      base::FilePath(component_folder_abs_path), config_.keys);
+  std::unique_ptr<Component> component =
+      Component::Create(base::FilePath(component_folder_abs_path),
+                        config_.keys, &manifest_cache_);
   if (!component)
     return false;
 
@@ -318,7 +319,7 @@ std::string ImageLoaderImpl::GetComponentVersion(const std::string& name) {
   }
 
   std::unique_ptr<Component> component =
-      Component::Create(component_path, config_.keys);
+      Component::Create(component_path, config_.keys, &manifest_cache_);
   if (!component)
     return kBadResult;
 
@@ -337,7 +338,7 @@ bool ImageLoaderImpl::GetComponentMetadata(
   }
 
   std::unique_ptr<Component> component =
-      Component::Create(component_path, config_.keys);
+      Component::Create(component_path, config_.keys, &manifest_cache_);
   if (!component)
     return false;
 
@@ -14,6 +14,7 @@
 #include <base/macros.h>
 
 #include "imageloader/helper_process_proxy.h"
+#include "imageloader/manifest_cache.h"
 
 namespace imageloader {
 
@@ -118,6 +119,11 @@ class ImageLoaderImpl {
   // The configuration traits.
   ImageLoaderConfig config_;
 
+  // Manifests already verified during the lifetime of the daemon. Chrome
+  // typically registers, queries and loads the same component in quick
+  // succession, so this avoids repeating the signature check for each call.
+  ManifestCache manifest_cache_;
+
   // Remove component if removable.
   bool RemoveComponentAtPath(const std::string& name,
                              const base::FilePath& component_root,
@@ -0,0 +1,67 @@
+// Copyright 2019 The Chromium OS Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "imageloader/manifest_cache.h"
+
+#include <stdint.h>
+
+#include <utility>
+
+#include <crypto/secure_hash.h>
+#include <crypto/sha2.h>
+
+namespace imageloader {
+
+namespace {
+
+// Hashes the length of |data| before the data itself so that the boundaries
+// between the concatenated fields are unambiguous.
+void UpdateWithField(crypto::SecureHash* hash, const void* data, size_t size) {
+  uint64_t size64 = size;
+  hash->Update(&size64, sizeof(size64));
+  hash->Update(data, size);
+}
+
+}  // namespace
+
+constexpr size_t ManifestCache::kMaxEntries;
+
+std::shared_ptr<const Manifest> ManifestCache::Lookup(
+    const std::vector<uint8_t>& public_key,
+    const std::string& manifest_raw,
+    const std::string& manifest_sig) const {
+  auto it = entries_.find(ComputeKey(public_key, manifest_raw, manifest_sig));
+  if (it == entries_.end())
+    return nullptr;
+  return it->second;
+}
+
+void ManifestCache::Insert(const std::vector<uint8_t>& public_key,
+                           const std::string& manifest_raw,
+                           const std::string& manifest_sig,
+                           std::shared_ptr<const Manifest> manifest) {
+  std::string key = ComputeKey(public_key, manifest_raw, manifest_sig);
+  // Components are few and rarely change within a session, so dropping an
+  // arbitrary entry once full is enough to keep memory bounded.
+  if (entries_.size() >= kMaxEntries && entries_.find(key) == entries_.end())
+    entries_.erase(entries_.begin());
+  entries_[key] = std::move(manifest);
+}
+
+// static
+std::string ManifestCache::ComputeKey(const std::vector<uint8_t>& public_key,
+                                      const std::string& manifest_raw,
+                                      const std::string& manifest_sig) {
+  std::unique_ptr<crypto::SecureHash> sha256(
+      crypto::SecureHash::Create(crypto::SecureHash::SHA256));
+  UpdateWithField(sha256.get(), public_key.data(), public_key.size());
+  UpdateWithField(sha256.get(), manifest_raw.data(), manifest_raw.size());
+  UpdateWithField(sha256.get(), manifest_sig.data(), manifest_sig.size());
+
+  std::string digest(crypto::kSHA256Length, '\0');
+  sha256->Finish(&digest[0], digest.size());
+  return digest;
+}
+
+}  // namespace imageloader
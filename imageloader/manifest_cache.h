@@ -0,0 +1,56 @@
+// Copyright 2019 The Chromium OS Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IMAGELOADER_MANIFEST_CACHE_H_
+#define IMAGELOADER_MANIFEST_CACHE_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <base/macros.h>
+
+#include "imageloader/manifest.h"
+
+namespace imageloader {
+
+// Caches manifests that have already passed signature verification and
+// parsing. Entries are keyed by the SHA-256 digest of the public key, the raw
+// manifest and its signature, so a hit means that exactly these bytes were
+// verified before and a modified manifest or signature always misses.
+class ManifestCache {
+ public:
+  // The maximum number of manifests kept in the cache.
+  static constexpr size_t kMaxEntries = 64;
+
+  ManifestCache() = default;
+
+  // Returns the manifest previously inserted for the given bytes, or nullptr
+  // if they have not been verified yet.
+  std::shared_ptr<const Manifest> Lookup(const std::vector<uint8_t>& public_key,
+                                         const std::string& manifest_raw,
+                                         const std::string& manifest_sig) const;
+
+  // Records |manifest| as the verified and parsed result for the given bytes.
+  void Insert(const std::vector<uint8_t>& public_key,
+              const std::string& manifest_raw,
+              const std::string& manifest_sig,
+              std::shared_ptr<const Manifest> manifest);
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  static std::string ComputeKey(const std::vector<uint8_t>& public_key,
+                                const std::string& manifest_raw,
+                                const std::string& manifest_sig);
+
+  std::map<std::string, std::shared_ptr<const Manifest>> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(ManifestCache);
+};
+
+}  // namespace imageloader
+
+#endif  // IMAGELOADER_MANIFEST_CACHE_H_
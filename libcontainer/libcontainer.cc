@@ -37,6 +37,7 @@
 #include <base/macros.h>
 #include <base/strings/string_util.h>
 #include <base/strings/stringprintf.h>
+#include <base/time/time.h>
 #include <libminijail.h>
 #include <scoped_minijail.h>
 
@@ -807,6 +808,17 @@ bool ContainerTeardown(struct container* c) {
   return true;
 }
 
+// Logs how long the phase of starting |c| that began at |*phase_start| took
+// and starts timing the next phase.
+void LogStartupPhase(const struct container* c,
+                     const char* phase,
+                     base::TimeTicks* phase_start) {
+  base::TimeTicks now = base::TimeTicks::Now();
+  VLOG(1) << "Starting " << c->name << ": " << phase << " took "
+          << (now - *phase_start).InMilliseconds() << "ms";
+  *phase_start = now;
+}
+
 void CancelContainerStart(struct container* c) {
   if (c->init_pid != -1)
     container_kill(c);
@@ -1290,6 +1302,9 @@ int container_start(struct container* c,
     return -1;
   }
 
+  const base::TimeTicks start_time = base::TimeTicks::Now();
+  base::TimeTicks phase_start = start_time;
+
   // This will run in all the error cases.
   base::ScopedClosureRunner teardown(
       base::Bind(&CancelContainerStart, base::Unretained(c)));
@@ -1303,6 +1318,7 @@ int container_start(struct container* c,
     if (!MountRunfs(c, config))
       return -1;
   }
+  LogStartupPhase(c, "runfs", &phase_start);
 
   c->jail.reset(minijail_new());
   if (!c->jail) {
@@ -1312,6 +1328,7 @@ int container_start(struct container* c,
 
   if (!DoContainerMounts(c, config))
     return -1;
+  LogStartupPhase(c, "mounts", &phase_start);
 
   int cgroup_uid;
   if (!GetUsernsOutsideId(config->uid_map, config->cgroup_owner, &cgroup_uid))
@@ -1327,6 +1344,7 @@ int container_start(struct container* c,
                                            cgroup_gid);
   if (!c->cgroup)
     return -1;
+  LogStartupPhase(c, "cgroup", &phase_start);
 
   // Must be root to modify device cgroup or mknod.
   std::map<minijail_hook_event_t, std::vector<libcontainer::HookCallback>>
@@ -1346,6 +1364,7 @@ int container_start(struct container* c,
     if (!DeviceSetup(c, config))
       return -1;
   }
+  LogStartupPhase(c, "devices", &phase_start);
 
   /* Setup CPU cgroup params. */
   if (config->cpu_cgparams.shares) {
@@ -1515,6 +1534,7 @@ int container_start(struct container* c,
   for (const auto& arg : config->program_argv)
     argv_cstr.emplace_back(const_cast<char*>(arg.c_str()));
   argv_cstr.emplace_back(nullptr);
+  LogStartupPhase(c, "jail setup", &phase_start);
 
   if (minijail_run_pid_pipes_no_preload(c->jail.get(), argv_cstr[0],
                                         argv_cstr.data(), &c->init_pid, nullptr,
@@ -1527,6 +1547,9 @@ int container_start(struct container* c,
     if (!hook_state.first.WaitForHookAndRun(hook_state.second, c->init_pid))
       return -1;
   }
+  LogStartupPhase(c, "run and hooks", &phase_start);
+  VLOG(1) << "Started " << c->name << " in "
+          << (phase_start - start_time).InMilliseconds() << "ms";
 
   // The container has started successfully, no need to tear it down anymore.
   ignore_result(teardown.Release());
@@ -38,6 +38,17 @@
 #define CLONE_NEWCGROUP 0x02000000
 #endif
 
+// LOOP_CONFIGURE (Linux 5.8) might not be in linux-headers yet.
+#ifndef LOOP_CONFIGURE
+#define LOOP_CONFIGURE 0x4C0A
+struct loop_config {
+  __u32 fd;
+  __u32 block_size;
+  struct loop_info64 info;
+  __u64 __reserved[8];
+};
+#endif
+
 namespace libcontainer {
 
 namespace {
@@ -186,6 +197,55 @@ void RemoveLoopDevice(int control_fd, int32_t device) {
     PLOG(ERROR) << "Failed to free /dev/loop" << device;
 }
 
+// Attaches |source_fd| to the free loop device |loop_fd| and sets its autoclear
+// flag. Where the kernel supports LOOP_CONFIGURE this is done atomically with
+// a single ioctl, which avoids the window in which the device is attached but
+// not yet autoclear, and saves the kernel from revalidating the device twice.
+// Returns false and sets |busy| if another process claimed the device first.
+bool AttachLoopDevice(int loop_fd,
+                      int source_fd,
+                      const base::FilePath& loopdev_path,
+                      bool* busy) {
+  *busy = false;
+
+  struct loop_config config = {};
+  config.fd = source_fd;
+  config.info.lo_flags = LO_FLAGS_AUTOCLEAR;
+  if (ioctl(loop_fd, LOOP_CONFIGURE, &config) == 0)
+    return true;
+  if (errno == EBUSY) {
+    *busy = true;
+    return false;
+  }
+  if (errno != EINVAL && errno != ENOTTY) {
+    PLOG(ERROR) << "Failed to ioctl(LOOP_CONFIGURE) " << loopdev_path.value();
+    return false;
+  }
+
+  // Older kernels: attach first and set the autoclear flag afterwards.
+  if (ioctl(loop_fd, LOOP_SET_FD, source_fd) < 0) {
+    if (errno == EBUSY) {
+      *busy = true;
+      return false;
+    }
+    PLOG(ERROR) << "Failed to ioctl(LOOP_SET_FD) " << loopdev_path.value();
+    return false;
+  }
+  struct loop_info64 loop_info = {};
+  if (ioctl(loop_fd, LOOP_GET_STATUS64, &loop_info) < 0) {
+    PLOG(ERROR) << "Failed to ioctl(LOOP_GET_STATUS64) "
+                << loopdev_path.value();
+    return false;
+  }
+  loop_info.lo_flags |= LO_FLAGS_AUTOCLEAR;
+  if (ioctl(loop_fd, LOOP_SET_STATUS64, &loop_info) < 0) {
+    PLOG(ERROR) << "Failed to ioctl(LOOP_SET_STATUS64, LO_FLAGS_AUTOCLEAR) "
+                << loopdev_path.value();
+    return false;
+  }
+  return true;
+}
+
 }  // namespace
 
 WaitablePipe::WaitablePipe() {
@@ -385,28 +445,25 @@ bool LoopdevSetup(const base::FilePath& source, Loopdev* loopdev_out) {
       return false;
     }
 
-    if (ioctl(loop_fd.get(), LOOP_SET_FD, source_fd.get()) < 0) {
-      if (errno != EBUSY) {
-        PLOG(ERROR) << "Failed to ioctl(LOOP_SET_FD) " << loopdev_path.value();
+    // Attach the source with the autoclear flag set, which will release the
+    // loop device when there are no more references to it.
+    bool busy;
+    if (!AttachLoopDevice(loop_fd.get(), source_fd.get(), loopdev_path,
+                          &busy)) {
+      if (!busy)
         return false;
-      }
+      // Another process raced us for this device. It is now in use, so it must
+      // not be removed.
+      ignore_result(loop_device_cleanup.Release());
       continue;
     }
 
-    // Set the autoclear flag on the loop device, which will release it when
-    // there are no more references to it.
     struct loop_info64 loop_info = {};
     if (ioctl(loop_fd.get(), LOOP_GET_STATUS64, &loop_info) < 0) {
       PLOG(ERROR) << "Failed to ioctl(LOOP_GET_STATUS64) "
                   << loopdev_path.value();
       return false;
     }
-    loop_info.lo_flags |= LO_FLAGS_AUTOCLEAR;
-    if (ioctl(loop_fd.get(), LOOP_SET_STATUS64, &loop_info) < 0) {
-      PLOG(ERROR) << "Failed to ioctl(LOOP_SET_STATUS64, LO_FLAGS_AUTOCLEAR) "
-                  << loopdev_path.value();
-      return false;
-    }
 
     ignore_result(loop_device_cleanup.Release());
     loopdev_out->path = loopdev_path;
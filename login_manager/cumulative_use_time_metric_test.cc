@@ -199,6 +199,11 @@ class TestMetricsLibrary : public MetricsLibraryInterface {
     return false;
   }
 
+  bool SendCrosEventToUMA(const std::string& event) override {
+    ADD_FAILURE() << "Should not be reached";
+    return false;
+  }
+
   bool SendToUMA(const std::string& name,
                  int sample,
                  int min,
@@ -28,6 +28,7 @@ class MetricsLibraryInterface {
   virtual bool SendBoolToUMA(const std::string& name, bool sample) = 0;
   virtual bool SendSparseToUMA(const std::string& name, int sample) = 0;
   virtual bool SendUserActionToUMA(const std::string& action) = 0;
+  virtual bool SendCrosEventToUMA(const std::string& event) = 0;
 #if USE_METRICS_UPLOADER
   virtual bool SendRepeatedToUMA(const std::string& name,
                                  int sample,
@@ -149,7 +150,7 @@ class MetricsLibrary : public MetricsLibraryInterface {
   // that is translated into an enumerated histogram entry.  Event names
   // must first be registered in metrics_library.cc.  See that file for
   // more details.
-  bool SendCrosEventToUMA(const std::string& event);
+  bool SendCrosEventToUMA(const std::string& event) override;
 
 #if USE_METRICS_UPLOADER
   // Sends |num_samples| samples with the same value to chrome.
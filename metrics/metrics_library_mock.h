@@ -25,6 +25,7 @@ class MetricsLibraryMock : public MetricsLibraryInterface {
   MOCK_METHOD2(SendBoolToUMA, bool(const std::string& name, bool sample));
   MOCK_METHOD2(SendSparseToUMA, bool(const std::string& name, int sample));
   MOCK_METHOD1(SendUserActionToUMA, bool(const std::string& action));
+  MOCK_METHOD1(SendCrosEventToUMA, bool(const std::string& event));
 #if USE_METRICS_UPLOADER
   MOCK_METHOD6(SendRepeatedToUMA,
                bool(const std::string& name,
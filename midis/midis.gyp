@@ -74,6 +74,7 @@
             'tests/client_tracker_test.cc',
             'tests/device_tracker_test.cc',
             'tests/seq_handler_test.cc',
+            'tests/subdevice_client_fd_holder_test.cc',
             'tests/test_helper.cc',
           ],
         },
@@ -25,6 +25,12 @@ const unsigned int kCreateOutputPortCaps =
 const unsigned int kCreatePortType =
     SND_SEQ_PORT_TYPE_MIDI_GENERIC | SND_SEQ_PORT_TYPE_APPLICATION;
 const char kSndSeqName[] = "hw";
+// Sizes (in events) of the user-space input buffer of the input client and of
+// its kernel-side input pool. Larger values let a single read() drain a burst
+// from high-rate controllers, and keep the kernel FIFO from overrunning while
+// events are being fanned out to clients.
+const size_t kSeqInputBufferEvents = 1024;
+const size_t kSeqClientPoolInput = 1000;
 
 }  // namespace
 
@@ -79,6 +85,19 @@ bool SeqHandler::InitSeq() {
     return false;
   }
 
+  // These are only tuning knobs, so failures are not fatal.
+  err = snd_seq_set_input_buffer_size(
+      in_client.get(), kSeqInputBufferEvents * sizeof(snd_seq_event_t));
+  if (err != 0) {
+    LOG(WARNING) << "snd_seq_set_input_buffer_size fails: "
+                 << snd_strerror(err);
+  }
+  err = snd_seq_set_client_pool_input(in_client.get(), kSeqClientPoolInput);
+  if (err != 0) {
+    LOG(WARNING) << "snd_seq_set_client_pool_input fails: "
+                 << snd_strerror(err);
+  }
+
   // Create input port.
   in_port_id_ = snd_seq_create_simple_port(
       in_client.get(), NULL, kCreateInputPortCaps, kCreatePortType);
@@ -4,6 +4,9 @@
 
 #include "midis/subdevice_client_fd_holder.h"
 
+#include <errno.h>
+#include <sys/socket.h>
+
 #include <memory>
 #include <utility>
 #include <vector>
@@ -15,6 +18,8 @@
 
 namespace midis {
 
+constexpr size_t SubDeviceClientFdHolder::kMaxPendingMessages;
+
 SubDeviceClientFdHolder::~SubDeviceClientFdHolder() { StopClientMonitoring(); }
 
 SubDeviceClientFdHolder::SubDeviceClientFdHolder(
@@ -25,6 +30,8 @@ SubDeviceClientFdHolder::SubDeviceClientFdHolder(
       fd_(std::move(fd)),
       client_data_cb_(client_data_cb),
       queue_(std::make_unique<midi::MidiMessageQueue>(true)),
+      write_taskid_(brillo::MessageLoop::kTaskIdNull),
+      dropped_messages_(0),
       weak_factory_(this) {}
 
 std::unique_ptr<SubDeviceClientFdHolder> SubDeviceClientFdHolder::Create(
@@ -41,15 +48,75 @@ std::unique_ptr<SubDeviceClientFdHolder> SubDeviceClientFdHolder::Create(
 void SubDeviceClientFdHolder::WriteDeviceDataToClient(const void* buffer,
                                                       size_t buf_len) {
   queue_->Add(reinterpret_cast<const uint8_t*>(buffer), buf_len);
-  std::vector<uint8_t> message;
-  queue_->Get(&message);
-  while (!message.empty()) {
-    ssize_t ret =
-        HANDLE_EINTR(write(GetRawFd(), message.data(), message.size()));
+  // |message_| keeps its capacity across calls, so the common case of short
+  // messages doesn't allocate.
+  queue_->Get(&message_);
+  while (!message_.empty()) {
+    SendMessageToClient(message_);
+    queue_->Get(&message_);
+  }
+}
+
+void SubDeviceClientFdHolder::SendMessageToClient(
+    const std::vector<uint8_t>& message) {
+  // Keep the messages in order behind those still waiting for the client.
+  if (pending_messages_.empty()) {
+    // Don't block: a client that stops reading must not delay delivery to
+    // every other client of every device.
+    ssize_t ret = HANDLE_EINTR(send(GetRawFd(), message.data(), message.size(),
+                                    MSG_DONTWAIT | MSG_NOSIGNAL));
+    if (ret == static_cast<ssize_t>(message.size()))
+      return;
+    if (ret >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+      PLOG(ERROR) << "Error writing to client fd.";
+      return;
+    }
+  }
+
+  if (pending_messages_.size() >= kMaxPendingMessages) {
+    if (dropped_messages_++ == 0) {
+      LOG(WARNING) << "Client id: " << client_id_ << " subdevice: "
+                   << subdevice_id_ << " is not reading, dropping messages.";
+    }
+    return;
+  }
+  pending_messages_.push_back(message);
+
+  if (write_taskid_ == brillo::MessageLoop::kTaskIdNull) {
+    write_taskid_ = brillo::MessageLoop::current()->WatchFileDescriptor(
+        FROM_HERE, fd_.get(), brillo::MessageLoop::kWatchWrite, false,
+        base::Bind(&SubDeviceClientFdHolder::FlushPendingMessages,
+                   weak_factory_.GetWeakPtr()));
+  }
+}
+
+void SubDeviceClientFdHolder::FlushPendingMessages() {
+  write_taskid_ = brillo::MessageLoop::kTaskIdNull;
+  while (!pending_messages_.empty()) {
+    const std::vector<uint8_t>& message = pending_messages_.front();
+    ssize_t ret = HANDLE_EINTR(send(GetRawFd(), message.data(), message.size(),
+                                    MSG_DONTWAIT | MSG_NOSIGNAL));
+    if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      write_taskid_ = brillo::MessageLoop::current()->WatchFileDescriptor(
+          FROM_HERE, fd_.get(), brillo::MessageLoop::kWatchWrite, false,
+          base::Bind(&SubDeviceClientFdHolder::FlushPendingMessages,
+                     weak_factory_.GetWeakPtr()));
+      return;
+    }
     if (ret != static_cast<ssize_t>(message.size())) {
+      // The client is gone; it will be removed via TriggerClientDeletion().
       PLOG(ERROR) << "Error writing to client fd.";
+      pending_messages_.clear();
+      break;
     }
-    queue_->Get(&message);
+    pending_messages_.pop_front();
+  }
+
+  if (dropped_messages_ > 0) {
+    LOG(WARNING) << "Client id: " << client_id_ << " subdevice: "
+                 << subdevice_id_ << " dropped " << dropped_messages_
+                 << " messages.";
+    dropped_messages_ = 0;
   }
 }
 
@@ -73,6 +140,8 @@ bool SubDeviceClientFdHolder::StartClientMonitoring() {
 void SubDeviceClientFdHolder::StopClientMonitoring() {
   brillo::MessageLoop::current()->CancelTask(pipe_taskid_);
   pipe_taskid_ = brillo::MessageLoop::kTaskIdNull;
+  brillo::MessageLoop::current()->CancelTask(write_taskid_);
+  write_taskid_ = brillo::MessageLoop::kTaskIdNull;
 }
 
 void SubDeviceClientFdHolder::HandleClientMidiData() {
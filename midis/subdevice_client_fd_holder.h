@@ -5,7 +5,9 @@
 #ifndef MIDIS_SUBDEVICE_CLIENT_FD_HOLDER_H_
 #define MIDIS_SUBDEVICE_CLIENT_FD_HOLDER_H_
 
+#include <deque>
 #include <memory>
+#include <vector>
 
 #include <base/files/scoped_file.h>
 #include <base/memory/weak_ptr.h>
@@ -29,6 +31,10 @@ class SubDeviceClientFdHolder {
       uint32_t client_id, uint32_t subdevice_id, base::ScopedFD fd,
       ClientDataCallback client_data_cb);
   ~SubDeviceClientFdHolder();
+  // Maximum number of messages queued for a client that isn't reading fast
+  // enough. Together with the socket buffer this covers a few seconds of a
+  // dense controller stream; beyond that the client is considered stuck.
+  static constexpr size_t kMaxPendingMessages = 1024;
   int GetRawFd() { return fd_.get(); }
   uint32_t GetClientId() const { return client_id_; }
   // This function is used to write data *to* the client when it is received
@@ -46,6 +52,12 @@ class SubDeviceClientFdHolder {
   // Starts the WatchFileDescriptor for the client pipe FD.
   bool StartClientMonitoring();
   void StopClientMonitoring();
+  // Sends |message| to the client, or queues it in |pending_messages_| if the
+  // client socket is full.
+  void SendMessageToClient(const std::vector<uint8_t>& message);
+  // Sends as many of |pending_messages_| as the client socket accepts, and
+  // waits for it to become writable again if any are left.
+  void FlushPendingMessages();
 
   uint32_t client_id_;
   uint32_t subdevice_id_;
@@ -53,6 +65,14 @@ class SubDeviceClientFdHolder {
   brillo::MessageLoop::TaskId pipe_taskid_;
   ClientDataCallback client_data_cb_;
   std::unique_ptr<midi::MidiMessageQueue> queue_;
+  // Scratch buffer for messages taken out of |queue_|.
+  std::vector<uint8_t> message_;
+  // Messages that didn't fit in the client socket, in the order they have
+  // to be delivered. Bounded by kMaxPendingMessages.
+  std::deque<std::vector<uint8_t>> pending_messages_;
+  brillo::MessageLoop::TaskId write_taskid_;
+  // Number of messages dropped since |pending_messages_| last filled up.
+  size_t dropped_messages_;
   base::WeakPtrFactory<SubDeviceClientFdHolder> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(SubDeviceClientFdHolder);
@@ -0,0 +1,138 @@
+// Copyright 2018 The Chromium OS Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <errno.h>
+#include <sys/socket.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <base/bind.h>
+#include <base/files/scoped_file.h>
+#include <base/posix/eintr_wrapper.h>
+#include <brillo/message_loops/base_message_loop.h>
+#include <gtest/gtest.h>
+
+#include "midis/constants.h"
+#include "midis/subdevice_client_fd_holder.h"
+
+namespace midis {
+
+namespace {
+
+constexpr uint32_t kClientId = 1;
+constexpr uint32_t kSubdeviceId = 0;
+constexpr int kMaxPendingMessages =
+    SubDeviceClientFdHolder::kMaxPendingMessages;
+
+void IgnoreClientData(uint32_t subdevice_id,
+                      const uint8_t* buffer,
+                      size_t buf_len) {}
+
+// Returns a distinct Note On message for every |index| below 128 * 128.
+std::vector<uint8_t> NoteOn(int index) {
+  return {0x90, static_cast<uint8_t>(index % 128),
+          static_cast<uint8_t>(index / 128)};
+}
+
+}  // namespace
+
+class SubDeviceClientFdHolderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    message_loop_.SetAsCurrent();
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds));
+    client_fd_.reset(fds[0]);
+    holder_ = SubDeviceClientFdHolder::Create(
+        kClientId, kSubdeviceId, base::ScopedFD(fds[1]),
+        base::Bind(&IgnoreClientData));
+    ASSERT_NE(nullptr, holder_);
+  }
+
+  // Fills the holder's end of the socket until it would block, and returns
+  // the number of packets that took.
+  int FillSocket() {
+    const uint8_t filler[3] = {0xF8, 0xF8, 0xF8};
+    int count = 0;
+    while (HANDLE_EINTR(send(holder_->GetRawFd(), filler, sizeof(filler),
+                             MSG_DONTWAIT | MSG_NOSIGNAL)) > 0) {
+      count++;
+    }
+    EXPECT_TRUE(errno == EAGAIN || errno == EWOULDBLOCK);
+    return count;
+  }
+
+  // Reads packets off the client end until |count| Note On messages have been
+  // received or nothing more arrives, running the message loop in between so
+  // the holder can flush its queue. Filler packets are skipped.
+  std::vector<std::vector<uint8_t>> ReadMessages(int count) {
+    std::vector<std::vector<uint8_t>> messages;
+    int idle_rounds = 0;
+    while (messages.size() < static_cast<size_t>(count) && idle_rounds < 10) {
+      bool got_any = false;
+      uint8_t buf[kMaxBufSize];
+      ssize_t ret;
+      while ((ret = HANDLE_EINTR(
+                  recv(client_fd_.get(), buf, sizeof(buf), MSG_DONTWAIT))) >
+             0) {
+        got_any = true;
+        if (buf[0] != 0xF8)
+          messages.emplace_back(buf, buf + ret);
+      }
+      message_loop_.RunOnce(false /* may_block */);
+      idle_rounds = got_any ? 0 : idle_rounds + 1;
+    }
+    return messages;
+  }
+
+  brillo::BaseMessageLoop message_loop_;
+  base::ScopedFD client_fd_;
+  std::unique_ptr<SubDeviceClientFdHolder> holder_;
+};
+
+// Messages that don't fit in the client socket are delivered in order once
+// the client reads again.
+TEST_F(SubDeviceClientFdHolderTest, QueuedMessagesDeliveredInOrder) {
+  ASSERT_GT(FillSocket(), 0);
+
+  const int kNumMessages = 100;
+  for (int i = 0; i < kNumMessages; ++i) {
+    std::vector<uint8_t> message = NoteOn(i);
+    holder_->WriteDeviceDataToClient(message.data(), message.size());
+  }
+
+  std::vector<std::vector<uint8_t>> received = ReadMessages(kNumMessages);
+  ASSERT_EQ(kNumMessages, static_cast<int>(received.size()));
+  for (int i = 0; i < kNumMessages; ++i)
+    EXPECT_EQ(NoteOn(i), received[i]) << "message " << i;
+
+  // With the queue drained, new messages go straight to the client.
+  std::vector<uint8_t> message = NoteOn(kNumMessages);
+  holder_->WriteDeviceDataToClient(message.data(), message.size());
+  received = ReadMessages(1);
+  ASSERT_EQ(1, static_cast<int>(received.size()));
+  EXPECT_EQ(message, received[0]);
+}
+
+// Once kMaxPendingMessages are queued, further messages are dropped rather
+// than queued without bound.
+TEST_F(SubDeviceClientFdHolderTest, OverflowIsDropped) {
+  ASSERT_GT(FillSocket(), 0);
+
+  const int kNumDropped = 10;
+  for (int i = 0; i < kMaxPendingMessages + kNumDropped; ++i) {
+    std::vector<uint8_t> message = NoteOn(i);
+    holder_->WriteDeviceDataToClient(message.data(), message.size());
+  }
+
+  std::vector<std::vector<uint8_t>> received =
+      ReadMessages(kMaxPendingMessages + kNumDropped);
+  ASSERT_EQ(kMaxPendingMessages, static_cast<int>(received.size()));
+  for (int i = 0; i < kMaxPendingMessages; ++i)
+    EXPECT_EQ(NoteOn(i), received[i]) << "message " << i;
+}
+
+}  // namespace midis
@@ -109,7 +109,8 @@ void Daemon::BootstrapMojoConnection(
   // Bind primordial message pipe to a MachineLearningService implementation.
   machine_learning_service_ = base::MakeUnique<MachineLearningServiceImpl>(
       mojo::edk::CreateChildMessagePipe(kBootstrapMojoConnectionChannelToken),
-      base::Bind(&Daemon::OnConnectionError, base::Unretained(this)));
+      base::Bind(&Daemon::OnConnectionError, base::Unretained(this)),
+      &metrics_);
 
   metrics_.RecordMojoConnectionEvent(
       Metrics::MojoConnectionEvent::kBootstrapSucceeded);
@@ -4,6 +4,7 @@
 
 #include "ml/graph_executor_impl.h"
 
+#include <algorithm>
 #include <set>
 #include <utility>
 #include <vector>
@@ -50,11 +51,11 @@ ExecuteResult PopulateInput(const TensorPtr& tensor,
   if (!shape_matches)
     return ExecuteResult::INPUT_SHAPE_ERROR;
 
+  // A single std::copy lets the compiler emit a memcpy (when the types match)
+  // or a vectorized conversion loop instead of per-element indexed stores.
   MemoryType* const input_memory = interpreter->typed_tensor<MemoryType>(index);
   const std::vector<TensorType>& tensor_values = tensor_view.GetValues();
-  for (int i = 0; i < tensor_values.size(); ++i) {
-    input_memory[i] = tensor_values[i];
-  }
+  std::copy(tensor_values.begin(), tensor_values.end(), input_memory);
 
   return ExecuteResult::OK;
 }
@@ -113,14 +114,12 @@ ExecuteResult PopulateOutput(const int index,
     num_entries *= dim_length;
   }
 
-  // Populate tensor values.
+  // Populate tensor values. Assigning the range directly avoids
+  // value-initializing the vector before overwriting every element.
   const MemoryType* const output_memory =
       interpreter.typed_tensor<MemoryType>(index);
   std::vector<TensorType>& tensor_values = tensor_view.GetValues();
-  tensor_values.resize(num_entries);
-  for (int i = 0; i < num_entries; ++i) {
-    tensor_values[i] = output_memory[i];
-  }
+  tensor_values.assign(output_memory, output_memory + num_entries);
 
   return ExecuteResult::OK;
 }
@@ -167,7 +166,10 @@ void GraphExecutorImpl::Execute(
     const std::vector<std::string>& outputs,
     const ExecuteCallback& callback) {
   // Validate input and output names (before executing graph, for efficiency).
+  // The resolved graph indices are kept so that each name is looked up once.
 
+  std::vector<std::pair<int, const TensorPtr*>> input_ids;
+  input_ids.reserve(tensors.size());
   for (const auto& kv : tensors) {
     const std::string& cur_input_name = kv.first;
 
@@ -177,6 +179,7 @@ void GraphExecutorImpl::Execute(
       callback.Run(ExecuteResult::UNKNOWN_INPUT_ERROR, base::nullopt);
       return;
     }
+    input_ids.emplace_back(name_lookup->second, &kv.second);
   }
   if (tensors.size() != required_inputs_.size()) {
     callback.Run(ExecuteResult::INPUT_MISSING_ERROR, base::nullopt);
@@ -184,6 +187,8 @@ void GraphExecutorImpl::Execute(
   }
 
   std::set<std::string> seen_outputs;
+  std::vector<int> output_ids;
+  output_ids.reserve(outputs.size());
   for (const auto& cur_output_name : outputs) {
     const auto name_lookup = required_outputs_.find(cur_output_name);
     if (name_lookup == required_outputs_.end() ||
@@ -191,6 +196,7 @@ void GraphExecutorImpl::Execute(
       callback.Run(ExecuteResult::UNKNOWN_OUTPUT_ERROR, base::nullopt);
       return;
     }
+    output_ids.push_back(name_lookup->second);
 
     // Specifying the same output twice is an error.
     const auto insert_result = seen_outputs.insert(cur_output_name);
@@ -205,12 +211,9 @@ void GraphExecutorImpl::Execute(
   }
 
   // Copy input data into the interpreter.
-  for (const auto& kv : tensors) {
-    const std::string& cur_input_name = kv.first;
-    const TensorPtr& cur_input = kv.second;
-
-    // Always valid, by the input name check at the start of this function.
-    const int cur_input_id = required_inputs_.find(cur_input_name)->second;
+  for (const auto& id_and_tensor : input_ids) {
+    const int cur_input_id = id_and_tensor.first;
+    const TensorPtr& cur_input = *id_and_tensor.second;
 
     // Check that the current input node is a supported type.
     const uint32_t cur_input_type = interpreter_->tensor(cur_input_id)->type;
@@ -240,13 +243,10 @@ void GraphExecutorImpl::Execute(
 
   // Extract output.
   std::vector<chromeos::machine_learning::mojom::TensorPtr> output_tensors;
-  for (const auto& cur_output_name : outputs) {
+  output_tensors.reserve(output_ids.size());
+  for (const int cur_output_id : output_ids) {
     output_tensors.push_back(Tensor::New());
 
-    // Always valid, by the output name check at the start of this function.
-    const int cur_output_id =
-        required_outputs_.find(cur_output_name)->second;
-
     // Check that the current output node is a supported type.
     const uint32_t cur_output_type = interpreter_->tensor(cur_output_id)->type;
     if (cur_output_type >= arraysize(kPopulateOutputFns)) {
@@ -259,7 +259,7 @@ void GraphExecutorImpl::Execute(
     // Attempt to extract data from the current output node.
     const ExecuteResult populate_output_result =
         (*kPopulateOutputFns[cur_output_type])(cur_output_id, *interpreter_,
-                                               *--output_tensors.end());
+                                               output_tensors.back());
     if (populate_output_result != ExecuteResult::OK) {
       callback.Run(populate_output_result, base::nullopt);
       return;
@@ -9,6 +9,9 @@
 
 #include <base/bind.h>
 #include <base/bind_helpers.h>
+#include <base/files/file_path.h>
+#include <base/files/file_util.h>
+#include <base/time/time.h>
 #include <tensorflow/contrib/lite/model.h>
 
 #include "ml/model_impl.h"
@@ -38,15 +41,39 @@ MachineLearningServiceImpl::MachineLearningServiceImpl(
     const std::string& model_dir)
     : model_metadata_(GetModelMetadata()),
       model_dir_(model_dir),
+      metrics_(nullptr),
       binding_(this, std::move(pipe)) {
   binding_.set_connection_error_handler(std::move(connection_error_handler));
 }
 
 MachineLearningServiceImpl::MachineLearningServiceImpl(
-    mojo::ScopedMessagePipeHandle pipe, base::Closure connection_error_handler)
-    : MachineLearningServiceImpl(std::move(pipe),
-                                 std::move(connection_error_handler),
-                                 kSystemModelDir) {}
+    mojo::ScopedMessagePipeHandle pipe,
+    base::Closure connection_error_handler,
+    Metrics* const metrics)
+    : model_metadata_(GetModelMetadata()),
+      model_dir_(kSystemModelDir),
+      metrics_(metrics),
+      binding_(this, std::move(pipe)) {
+  binding_.set_connection_error_handler(std::move(connection_error_handler));
+}
+
+int MachineLearningServiceImpl::num_cached_models_for_testing() const {
+  int num_models = 0;
+  for (const auto& kv : model_cache_) {
+    if (!kv.second.model.expired())
+      ++num_models;
+  }
+  return num_models;
+}
+
+int64_t MachineLearningServiceImpl::GetSharedModelBytes() const {
+  int64_t total_bytes = 0;
+  for (const auto& kv : model_cache_) {
+    if (!kv.second.model.expired())
+      total_bytes += kv.second.mapped_bytes;
+  }
+  return total_bytes;
+}
 
 void MachineLearningServiceImpl::LoadModel(ModelSpecPtr spec,
                                            ModelRequest request,
@@ -66,14 +93,36 @@ void MachineLearningServiceImpl::LoadModel(ModelSpecPtr spec,
   }
   const ModelMetadata& metadata = metadata_lookup->second;
 
-  // Attempt to load model.
-  const std::string model_path = model_dir_ + metadata.model_file;
-  std::unique_ptr<tflite::FlatBufferModel> model =
-      tflite::FlatBufferModel::BuildFromFile(model_path.c_str());
-  if (model == nullptr) {
-    LOG(ERROR) << "Failed to load model file '" << model_path << "'.";
-    callback.Run(LoadModelResult::LOAD_MODEL_ERROR);
-    return;
+  // Reuse the model if another client still holds it. The flatbuffer is a
+  // read-only mapping of the model file, so it is safe to share.
+  const base::TimeTicks load_start = base::TimeTicks::Now();
+  CachedModel& cached_model = model_cache_[spec->id];
+  std::shared_ptr<const tflite::FlatBufferModel> model =
+      cached_model.model.lock();
+  const bool cached = model != nullptr;
+  if (!cached) {
+    const std::string model_path = model_dir_ + metadata.model_file;
+    model = tflite::FlatBufferModel::BuildFromFile(model_path.c_str());
+    if (model == nullptr) {
+      LOG(ERROR) << "Failed to load model file '" << model_path << "'.";
+      callback.Run(LoadModelResult::LOAD_MODEL_ERROR);
+      return;
+    }
+    cached_model.model = model;
+    // BuildFromFile() maps the whole file.
+    if (!base::GetFileSize(base::FilePath(model_path),
+                           &cached_model.mapped_bytes)) {
+      cached_model.mapped_bytes = 0;
+    }
+  }
+
+  if (metrics_) {
+    metrics_->RecordModelLoadTime(cached,
+                                  base::TimeTicks::Now() - load_start);
+    // The shared mappings are clean and file-backed, so they don't show up in
+    // the private memory metrics.
+    if (!cached)
+      metrics_->RecordSharedModelMemory(GetSharedModelBytes() / 1024);
   }
 
   // Use a connection error handler to strongly bind |model_impl| to |request|.
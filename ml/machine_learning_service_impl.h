@@ -6,12 +6,15 @@
 #define ML_MACHINE_LEARNING_SERVICE_IMPL_H_
 
 #include <map>
+#include <memory>
 #include <string>
 
 #include <base/callback_forward.h>
 #include <base/macros.h>
 #include <mojo/public/cpp/bindings/binding.h>
+#include <tensorflow/contrib/lite/model.h>
 
+#include "ml/metrics.h"
 #include "ml/model_metadata.h"
 #include "ml/mojom/machine_learning_service.mojom.h"
 
@@ -22,9 +25,14 @@ class MachineLearningServiceImpl
  public:
   // Creates an instance bound to |pipe|. The specified
   // |connection_error_handler| will be invoked if the binding encounters a
-  // connection error.
+  // connection error. Model loading is reported to |metrics|, which must
+  // outlive this object.
   MachineLearningServiceImpl(mojo::ScopedMessagePipeHandle pipe,
-                             base::Closure connection_error_handler);
+                             base::Closure connection_error_handler,
+                             Metrics* metrics);
+
+  // Returns the number of models currently loaded and shared between clients.
+  int num_cached_models_for_testing() const;
 
  protected:
   // Testing constructor that allows overriding of the model dir. Should not be
@@ -44,6 +52,24 @@ class MachineLearningServiceImpl
       model_metadata_;
   const std::string model_dir_;
 
+  // Not owned. May be null in tests.
+  Metrics* const metrics_;
+
+  // A loaded model and the size of its mapping of the model file.
+  struct CachedModel {
+    std::weak_ptr<const tflite::FlatBufferModel> model;
+    int64_t mapped_bytes = 0;
+  };
+
+  // Returns the total size of the file mappings of the models still loaded.
+  int64_t GetSharedModelBytes() const;
+
+  // Loaded models, shared by every ModelImpl created for the same model ID.
+  // Entries only hold weak references, so a model's mapping is released as
+  // soon as its last ModelImpl is destroyed.
+  std::map<chromeos::machine_learning::mojom::ModelId, CachedModel>
+      model_cache_;
+
   mojo::Binding<chromeos::machine_learning::mojom::MachineLearningService>
       binding_;
 
@@ -151,5 +151,38 @@ TEST(MachineLearningServiceImplTest, TestInference) {
   ASSERT_TRUE(infer_callback_done);
 }
 
+// Test that loading the same model twice shares a single copy of it.
+TEST(MachineLearningServiceImplTest, TestModelIsShared) {
+  MachineLearningServicePtr ml_service;
+  const MachineLearningServiceImplForTesting ml_service_impl(
+      mojo::MakeRequest(&ml_service).PassMessagePipe());
+
+  ModelPtr models[2];
+  for (ModelPtr& model : models) {
+    ModelSpecPtr spec = ModelSpec::New();
+    spec->id = ModelId::TEST_MODEL;
+
+    bool model_callback_done = false;
+    ml_service->LoadModel(
+        std::move(spec), mojo::MakeRequest(&model),
+        base::Bind(
+            [](bool* model_callback_done, const LoadModelResult result) {
+              EXPECT_EQ(result, LoadModelResult::OK);
+              *model_callback_done = true;
+            },
+            &model_callback_done));
+    base::RunLoop().RunUntilIdle();
+    ASSERT_TRUE(model_callback_done);
+    ASSERT_TRUE(model.is_bound());
+  }
+  EXPECT_EQ(ml_service_impl.num_cached_models_for_testing(), 1);
+
+  // The model is released once no client holds it anymore.
+  models[0].reset();
+  models[1].reset();
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(ml_service_impl.num_cached_models_for_testing(), 0);
+}
+
 }  // namespace
 }  // namespace ml
@@ -26,6 +26,12 @@ constexpr char kPrivateMemoryMetricName[] =
     "MachineLearningService.PrivateMemoryKb";
 constexpr char kPeakPrivateMemoryMetricName[] =
     "MachineLearningService.PeakPrivateMemoryKb";
+constexpr char kColdModelLoadTimeMetricName[] =
+    "MachineLearningService.LoadModelTimeUs.Cold";
+constexpr char kWarmModelLoadTimeMetricName[] =
+    "MachineLearningService.LoadModelTimeUs.Warm";
+constexpr char kSharedModelMemoryMetricName[] =
+    "MachineLearningService.SharedModelMemoryKb";
 
 // UMA histogram ranges:
 constexpr int kCpuUsageMinMilliPercent = 1;       // 0.001%
@@ -34,6 +40,9 @@ constexpr int kCpuUsageBuckets = 25;
 constexpr int kMemoryUsageMinKb = 10;         // 10 KB
 constexpr int kMemoryUsageMaxKb = 100000000;  // 100 GB
 constexpr int kMemoryUsageBuckets = 100;
+constexpr int kModelLoadTimeMinUs = 1;         // 1 us
+constexpr int kModelLoadTimeMaxUs = 10000000;  // 10 s
+constexpr int kModelLoadTimeBuckets = 50;
 
 // chromeos_metrics::CumulativeMetrics constants:
 constexpr char kCumulativeMetricsBackingDir[] = "/var/lib/ml_service/metrics";
@@ -122,4 +131,18 @@ void Metrics::RecordMojoConnectionEvent(const MojoConnectionEvent event) {
                                  static_cast<int>(MojoConnectionEvent::kMax));
 }
 
+void Metrics::RecordModelLoadTime(const bool cached,
+                                  const base::TimeDelta load_time) {
+  metrics_library_.SendToUMA(
+      cached ? kWarmModelLoadTimeMetricName : kColdModelLoadTimeMetricName,
+      static_cast<int>(load_time.InMicroseconds()), kModelLoadTimeMinUs,
+      kModelLoadTimeMaxUs, kModelLoadTimeBuckets);
+}
+
+void Metrics::RecordSharedModelMemory(const int64_t size_kb) {
+  metrics_library_.SendToUMA(kSharedModelMemoryMetricName,
+                             static_cast<int>(size_kb), kMemoryUsageMinKb,
+                             kMemoryUsageMaxKb, kMemoryUsageBuckets);
+}
+
 }  // namespace ml
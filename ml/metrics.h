@@ -9,6 +9,7 @@
 
 #include <base/macros.h>
 #include <base/process/process_metrics.h>
+#include <base/time/time.h>
 #include <metrics/cumulative_metrics.h>
 #include <metrics/metrics_library.h>
 
@@ -42,6 +43,14 @@ class Metrics {
 
   void RecordMojoConnectionEvent(MojoConnectionEvent event);
 
+  // Records how long LoadModel took. |cached| is true if the model was
+  // already loaded for another client and did not need to be read from disk.
+  void RecordModelLoadTime(bool cached, base::TimeDelta load_time);
+
+  // Records the total size of the model file mappings shared between clients,
+  // which is the most they add to the resident memory of the daemon.
+  void RecordSharedModelMemory(int64_t size_kb);
+
  private:
   // Fetches process metrics (e.g. RAM) and updates |cumulative_metrics|.
   // If |record_current_metrics| is true, also logs current process metrics.
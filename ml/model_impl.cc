@@ -10,7 +10,6 @@
 #include <base/bind_helpers.h>
 #include <tensorflow/contrib/lite/context.h>
 #include <tensorflow/contrib/lite/interpreter.h>
-#include <tensorflow/contrib/lite/kernels/register.h>
 
 namespace ml {
 
@@ -21,7 +20,7 @@ using ::chromeos::machine_learning::mojom::ModelRequest;
 
 ModelImpl::ModelImpl(const std::map<std::string, int>& required_inputs,
                      const std::map<std::string, int>& required_outputs,
-                     std::unique_ptr<tflite::FlatBufferModel> model,
+                     std::shared_ptr<const tflite::FlatBufferModel> model,
                      ModelRequest request)
     : required_inputs_(required_inputs),
       required_outputs_(required_outputs),
@@ -46,10 +45,9 @@ void ModelImpl::CreateGraphExecutor(
   }
 
   // Instantiate interpreter.
-  tflite::ops::builtin::BuiltinOpResolver resolver;
   std::unique_ptr<tflite::Interpreter> interpreter;
   const TfLiteStatus resolve_status =
-      tflite::InterpreterBuilder(*model_, resolver)(&interpreter);
+      tflite::InterpreterBuilder(*model_, resolver_)(&interpreter);
   if (resolve_status != kTfLiteOk || !interpreter) {
     LOG(ERROR) << "Could not resolve model ops.";
     callback.Run(CreateGraphExecutorResult::MODEL_INTERPRETATION_ERROR);
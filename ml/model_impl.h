@@ -12,6 +12,7 @@
 
 #include <base/macros.h>
 #include <mojo/public/cpp/bindings/binding.h>
+#include <tensorflow/contrib/lite/kernels/register.h>
 #include <tensorflow/contrib/lite/model.h>
 
 #include "ml/graph_executor_impl.h"
@@ -24,7 +25,8 @@ namespace ml {
 //
 // All GraphExecutors created by a ModelImpl reference its model definition (and
 // hence may not outlive the ModelImpl). Multiple such GraphExecutors may be
-// used concurrently from different sequences.
+// used concurrently from different sequences. The model definition itself may
+// be shared with other ModelImpls.
 class ModelImpl : public chromeos::machine_learning::mojom::Model {
  public:
   // Creates an instance bound to |request|.
@@ -34,7 +36,7 @@ class ModelImpl : public chromeos::machine_learning::mojom::Model {
   // graph, and must outlive this object.
   ModelImpl(const std::map<std::string, int>& required_inputs,
             const std::map<std::string, int>& required_outputs,
-            std::unique_ptr<tflite::FlatBufferModel> model,
+            std::shared_ptr<const tflite::FlatBufferModel> model,
             chromeos::machine_learning::mojom::ModelRequest request);
 
   void set_connection_error_handler(base::Closure connection_error_handler);
@@ -53,7 +55,10 @@ class ModelImpl : public chromeos::machine_learning::mojom::Model {
   const std::map<std::string, int>& required_inputs_;
   const std::map<std::string, int>& required_outputs_;
 
-  const std::unique_ptr<tflite::FlatBufferModel> model_;
+  const std::shared_ptr<const tflite::FlatBufferModel> model_;
+
+  // Built once and reused for every GraphExecutor created from this model.
+  const tflite::ops::builtin::BuiltinOpResolver resolver_;
 
   mojo::Binding<chromeos::machine_learning::mojom::Model> binding_;
 
@@ -15,6 +15,7 @@
 #include <fcntl.h>
 #include <netinet/in.h>
 #include <stdint.h>
+#include <sys/sendfile.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -62,7 +63,8 @@ ConnectionDelegate::ConnectionDelegate(int dirfd,
       pretty_addr_(pretty_addr),
       server_(server),
       max_download_rate_(max_download_rate),
-      total_bytes_sent_(0) {
+      total_bytes_sent_(0),
+      use_sendfile_(true) {
   CHECK_NE(-1, fd_);
   CHECK(server_ != NULL);
 }
@@ -333,25 +335,66 @@ static bool ParseRange(const string& range_str,
   return false;
 }
 
+ssize_t ConnectionDelegate::SendFileChunk(int file_fd, size_t num_to_send) {
+  if (use_sendfile_) {
+    // sendfile(2) moves the data from the page cache to the socket without
+    // copying it through user space. It returns 0 at EOF, just like read(2).
+    ssize_t num_sent = sendfile(fd_, file_fd, NULL, num_to_send);
+    if (num_sent >= 0)
+      return num_sent;
+    if (errno != EINVAL && errno != ENOSYS) {
+      PLOG(ERROR) << "Error sending";
+      return -1;
+    }
+    // The filesystem doesn't support sendfile(2); copy the data instead.
+    VLOG(1) << "sendfile() not supported, falling back to read()/send()";
+    use_sendfile_ = false;
+  }
+
+  char buf[kPayloadBufferSize];
+  ssize_t num_read = read(file_fd, buf, std::min(sizeof buf, num_to_send));
+  if (num_read <= 0) {
+    // Note that the file is expected to be on a filesystem so Linux
+    // guarantees that we never get EAGAIN. In other words, we never
+    // get partial reads e.g. either we get everything we ask for or
+    // none of it.
+    if (num_read < 0)
+      PLOG(ERROR) << "Error reading";
+    return num_read;
+  }
+
+  size_t num_to_send_from_buf = num_read;
+  size_t num_sent_from_buf = 0;
+  while (num_to_send_from_buf > 0) {
+    ssize_t num_sent =
+        send(fd_, buf + num_sent_from_buf, num_to_send_from_buf, 0);
+    if (num_sent == -1) {
+      PLOG(ERROR) << "Error sending";
+      return -1;
+    }
+    CHECK_GT(num_sent, 0);
+    num_to_send_from_buf -= num_sent;
+    num_sent_from_buf += num_sent;
+  }
+  return num_sent_from_buf;
+}
+
 bool ConnectionDelegate::SendFile(int file_fd, size_t num_bytes_to_send) {
   ClockInterface *clock;
   total_time_spent_ = TimeDelta();
   int seconds_spent_waiting = 0;
-  char buf[kPayloadBufferSize];
 
   clock = server_->Clock();
 
   total_bytes_sent_ = 0;
   while (total_bytes_sent_ < num_bytes_to_send) {
-    size_t num_to_read = std::min(sizeof buf,
+    size_t num_to_send = std::min(static_cast<size_t>(kPayloadBufferSize),
                                   num_bytes_to_send - total_bytes_sent_);
-    size_t num_to_send_from_buf;
-    size_t num_sent_from_buf;
-    ssize_t num_read;
+    ssize_t num_sent;
 
     Time time_start = clock->GetMonotonicTime();
-    num_read = read(file_fd, buf, num_to_read);
-    if (num_read == 0) {
+    num_sent = SendFileChunk(file_fd, num_to_send);
+    if (num_sent == 0) {
       // EOF - handle this by sleeping and trying again later.
       VLOG(1) << "Got EOF so sleeping one second";
       // Don't include the time sleeping in total_time_spent_.
@@ -367,29 +410,11 @@ bool ConnectionDelegate::SendFile(int file_fd, size_t num_bytes_to_send) {
         LOG(INFO) << pretty_addr_ << " - peer no longer connected; giving up";
         return false;
       }
-    } else if (num_read < 0) {
-      // Note that the file is expected to be on a filesystem so Linux
-      // guarantees that we never get EAGAIN. In other words, we never
-      // get partial reads e.g. either we get everything we ask for or
-      // none of it.
-      PLOG(ERROR) << "Error reading";
+    } else if (num_sent < 0) {
       return false;
     }
 
-    num_to_send_from_buf = num_read;
-    num_sent_from_buf = 0;
-    while (num_to_send_from_buf > 0) {
-      ssize_t num_sent =
-          send(fd_, buf + num_sent_from_buf, num_to_send_from_buf, 0);
-      if (num_sent == -1) {
-        PLOG(ERROR) << "Error sending";
-        return false;
-      }
-      CHECK_GT(num_sent, 0);
-      num_to_send_from_buf -= num_sent;
-      num_sent_from_buf += num_sent;
-    }
-    total_bytes_sent_ += num_sent_from_buf;
+    total_bytes_sent_ += num_sent;
     total_time_spent_ += clock->GetMonotonicTime() - time_start;
 
     // Limit download speed, if requested. Right now the speed is
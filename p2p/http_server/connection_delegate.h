@@ -87,13 +87,20 @@ class ConnectionDelegate : public ConnectionDelegateInterface {
       const std::string& http_version,
       const std::map<std::string, std::string>& headers);
 
+  // Sends up to |num_to_send| bytes from the current position of
+  // |file_fd| to the socket. Uses sendfile(2) so the data doesn't go
+  // through user space, falling back to read(2)/send(2) if the file
+  // doesn't support it. Returns the number of bytes sent, 0 at EOF or
+  // -1 on error.
+  ssize_t SendFileChunk(int file_fd, size_t num_to_send);
+
   // Sends |num_bytes_to_send_bytes| from the file represented by the
   // file descriptor |file_fd|. Returns false if an error occurs while
   // doing this.
   //
-  // The implementation will read |kPayloadBufferSize| at once (except
-  // for at the end where it is clipped accordingly) and send this
-  // to the other end.
+  // The implementation will send at most |kPayloadBufferSize| at once
+  // (except for at the end where it is clipped accordingly) using
+  // SendFileChunk().
   //
   // If read(2) returns EOF, will sleep for one second and then retry.
   // This is for situations where the final file size is known in
@@ -148,6 +155,10 @@ class ConnectionDelegate : public ConnectionDelegateInterface {
   // report metrics.
   size_t total_bytes_sent_;
 
+  // Whether sendfile(2) can be used for the file being served. Cleared
+  // the first time the kernel reports it's unsupported for the file.
+  bool use_sendfile_;
+
   // The total time spent to send |total_bytes_send_| during the last
   // call to SendFile(). Used to report metrics.
   base::TimeDelta total_time_spent_;
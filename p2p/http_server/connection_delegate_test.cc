@@ -446,6 +446,43 @@ TEST_F(ConnectionDelegateTest, GetExistentFile) {
   EXPECT_EQ(base::IntToString(content.size()), resp.headers_["Content-Length"]);
 }
 
+// Serves a file spanning several payload chunks from an offset that isn't
+// chunk-aligned, to check that data isn't lost or repeated between chunks.
+TEST_F(ConnectionDelegateTest, GetRangeOfMultiChunkFile) {
+  SetupDelegate();
+
+  const size_t file_size = 3 * 65536 + 123;
+  const size_t range_first = 1000;
+  string content;
+  GeneratePrintableData(file_size, &content);
+  WriteFile(testdir_path_.Append("big.p2p"), content.c_str(), content.size());
+
+  EXPECT_CALL(mock_server_, ReportServerMessage(
+      p2p::util::kP2PServerRequestResult,
+      p2p::util::kP2PRequestResultResponseSent));
+  EXPECT_CALL(mock_server_, ReportServerMessage(
+      p2p::util::kP2PServerServedSuccessfullyMB, 0));
+  EXPECT_CALL(mock_server_, ReportServerMessage(
+      p2p::util::kP2PServerDownloadSpeedKBps, _));
+  EXPECT_CALL(mock_server_, ReportServerMessage(
+      p2p::util::kP2PServerRangeBeginPercentage, 0));
+  EXPECT_CALL(mock_server_, ConnectionTerminated(delegate_));
+
+  thread_->Start();
+  HTTPRequest req;
+  req.uri_ = "/big";
+  req.headers_["Range"] = "bytes=" + std::to_string(range_first) + "-";
+  req.Send(client_fd_);
+  string text_resp;
+  EXPECT_TRUE(ReadHTTPResponse(client_fd_, &text_resp));
+  thread_->Join();
+
+  HTTPResponse resp(text_resp);
+  ASSERT_TRUE(resp.valid_);
+  EXPECT_EQ(206, resp.http_code_);
+  EXPECT_EQ(content.substr(range_first), resp.content_);
+}
+
 TEST_F(ConnectionDelegateTest, PostExistentFile) {
   SetupDelegate();
 
@@ -89,19 +89,20 @@ bool NeighborCache::GetInterfaceRouter(const std::string& if_name,
                                        const std::string& pg_name,
                                        NeighborCacheEntry* entry_out) const {
   DCHECK(entry_out);
+  auto routers_it = router_index_.find(std::make_pair(if_name, pg_name));
+  if (routers_it == router_index_.end())
+    return false;
+
   // Using an initial score of 0 to prevent routers in a FAILED states from
   // being returned.
   int nud_score = 0;
-  for (const auto& pair : entries_) {
-    // Check if potential match, skip if not.
-    if (!pair.second.is_router || pair.second.if_name != if_name ||
-        pair.first.second != pg_name) {
-      continue;
-    }
-    int new_nud_score = GetNudScore(pair.second.nud_state);
+  for (const IPAddress& ip_address : routers_it->second) {
+    auto it = entries_.find(KeyPair(ip_address, pg_name));
+    DCHECK(it != entries_.end());
+    int new_nud_score = GetNudScore(it->second.nud_state);
     if (new_nud_score > nud_score) {
       nud_score = new_nud_score;
-      *entry_out = pair.second;
+      *entry_out = it->second;
     }
   }
   return nud_score > 0;
@@ -124,49 +125,98 @@ bool NeighborCache::InsertEntry(const string& pg_name,
     return false;
   }
   const KeyPair key(entry.ip_address, pg_name);
-  NeighborCacheEntry& new_entry = entries_[key];
-  new_entry = entry;
-  entries_[key].expiry_time = now + kEntryExpiryTimeout;
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    it = entries_.emplace(key, entry).first;
+  } else {
+    // The interface, router flag and expiry time may all change.
+    UnindexEntry(it);
+    it->second = entry;
+  }
+  it->second.expiry_time = now + kEntryExpiryTimeout;
+  IndexEntry(it);
   return true;
 }
 
 void NeighborCache::RemoveEntry(const IPAddress& ip_address,
                                 const string& pg_name) {
-  entries_.erase(KeyPair(ip_address, pg_name));
+  auto it = entries_.find(KeyPair(ip_address, pg_name));
+  if (it != entries_.end())
+    EraseEntry(it);
 }
 
 void NeighborCache::ClearForInterface(const string& if_name) {
-  for (auto it = entries_.begin(); it != entries_.end();) {
-    if (it->second.if_name == if_name) {
-      it = entries_.erase(it);
-    } else {
-      ++it;
-    }
+  auto index_it = interface_index_.find(if_name);
+  while (index_it != interface_index_.end()) {
+    // Erasing the last entry on the interface also drops |index_it|.
+    EraseEntry(entries_.find(*index_it->second.begin()));
+    index_it = interface_index_.find(if_name);
   }
 }
 
 void NeighborCache::ClearForGroup(const string& pg_name) {
-  for (auto it = entries_.begin(); it != entries_.end();) {
-    if (it->first.second == pg_name) {
-      it = entries_.erase(it);
-    } else {
-      ++it;
-    }
+  auto index_it = group_index_.find(pg_name);
+  while (index_it != group_index_.end()) {
+    EraseEntry(entries_.find(KeyPair(*index_it->second.begin(), pg_name)));
+    index_it = group_index_.find(pg_name);
   }
 }
 
 void NeighborCache::Clear() {
   entries_.clear();
+  interface_index_.clear();
+  group_index_.clear();
+  router_index_.clear();
+  expiry_queue_.clear();
 }
 
 void NeighborCache::ClearExpired(TimeTicks now) {
-  for (auto it = entries_.begin(); it != entries_.end();) {
-    if (it->second.expiry_time <= now) {
-      it = entries_.erase(it);
-    } else {
-      ++it;
-    }
+  while (!expiry_queue_.empty() && expiry_queue_.begin()->first <= now)
+    EraseEntry(entries_.find(expiry_queue_.begin()->second));
+}
+
+void NeighborCache::IndexEntry(EntryMap::const_iterator it) {
+  const Key& key = it->first;
+  const NeighborCacheEntry& entry = it->second;
+  interface_index_[entry.if_name].insert(key);
+  group_index_[key.second].insert(key.first);
+  if (entry.is_router)
+    router_index_[std::make_pair(entry.if_name, key.second)].insert(key.first);
+  expiry_queue_.emplace(entry.expiry_time, key);
+}
+
+void NeighborCache::UnindexEntry(EntryMap::const_iterator it) {
+  const Key& key = it->first;
+  const NeighborCacheEntry& entry = it->second;
+
+  auto if_it = interface_index_.find(entry.if_name);
+  DCHECK(if_it != interface_index_.end());
+  if_it->second.erase(key);
+  if (if_it->second.empty())
+    interface_index_.erase(if_it);
+
+  auto group_it = group_index_.find(key.second);
+  DCHECK(group_it != group_index_.end());
+  group_it->second.erase(key.first);
+  if (group_it->second.empty())
+    group_index_.erase(group_it);
+
+  if (entry.is_router) {
+    auto router_it =
+        router_index_.find(std::make_pair(entry.if_name, key.second));
+    DCHECK(router_it != router_index_.end());
+    router_it->second.erase(key.first);
+    if (router_it->second.empty())
+      router_index_.erase(router_it);
   }
+
+  expiry_queue_.erase(std::make_pair(entry.expiry_time, key));
+}
+
+void NeighborCache::EraseEntry(EntryMap::iterator it) {
+  DCHECK(it != entries_.end());
+  UnindexEntry(it);
+  entries_.erase(it);
 }
 
 }  // namespace portier
@@ -6,6 +6,7 @@
 #define PORTIER_NEIGHBOR_CACHE_H_
 
 #include <map>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -37,6 +38,9 @@ struct NeighborCacheEntry {
 // Manages the cache of neighbour enteries.  Each entry is keyed by
 // its IPv6 address and a group name.  The neighbor cache does not
 // validate the normal rules of proxy group memberships.
+// Entries are additionally indexed by interface, by group, by expiry
+// time and, for routers, by interface-group pair, so that none of the
+// operations need to walk the whole cache.
 // This class is not thread safe and is intended to run a single threaded
 // event loop.
 class NeighborCache {
@@ -101,10 +105,30 @@ class NeighborCache {
   void ClearExpired(base::TimeTicks now = base::TimeTicks::Now());
 
  private:
-  // Maps the pair of the string representation of the IPv6 address
-  // and the group name to a neighbor cache entry.
-  std::map<std::pair<shill::IPAddress, std::string>, NeighborCacheEntry>
-      entries_;
+  using Key = std::pair<shill::IPAddress, std::string>;
+  using EntryMap = std::map<Key, NeighborCacheEntry>;
+
+  // Adds or removes the entry pointed to by |it| from the secondary
+  // indexes.
+  void IndexEntry(EntryMap::const_iterator it);
+  void UnindexEntry(EntryMap::const_iterator it);
+
+  // Removes the entry pointed to by |it| from the cache and all indexes.
+  void EraseEntry(EntryMap::iterator it);
+
+  // Maps the pair of the IPv6 address and the group name to a neighbor
+  // cache entry.
+  EntryMap entries_;
+
+  // Keys of the entries on each interface.
+  std::map<std::string, std::set<Key>> interface_index_;
+  // IP addresses of the entries in each group.
+  std::map<std::string, std::set<shill::IPAddress>> group_index_;
+  // IP addresses of the routers for each interface name-group name pair.
+  std::map<std::pair<std::string, std::string>, std::set<shill::IPAddress>>
+      router_index_;
+  // Keys of all entries ordered by expiry time.
+  std::set<std::pair<base::TimeTicks, Key>> expiry_queue_;
 };
 
 }  // namespace portier
@@ -345,6 +345,40 @@ TEST_F(NeighborCacheTest, GetRouter) {
   EXPECT_TRUE(CompareEntries(entry, router3_));
 }
 
+TEST_F(NeighborCacheTest, ReinsertMovesRouter) {
+  NeighborCache cache;
+  EXPECT_TRUE(InsertAll(&cache));
+
+  // Move Router 1 from upstream 1 to upstream 2 within group 1.
+  router1_.if_name = kUpsteamInterface2;
+  EXPECT_TRUE(cache.InsertEntry(kGroupName1, router1_, now_));
+
+  NeighborCacheEntry entry;
+  EXPECT_FALSE(
+      cache.GetInterfaceRouter(kUpsteamInterface1, kGroupName1, &entry));
+  EXPECT_TRUE(
+      cache.GetInterfaceRouter(kUpsteamInterface2, kGroupName1, &entry));
+  EXPECT_TRUE(CompareEntries(entry, router1_));
+
+  // Router 1 is no longer on upstream 1, so clearing it leaves Router 1
+  // but removes Node 3.
+  cache.ClearForInterface(kUpsteamInterface1);
+  EXPECT_TRUE(cache.HasEntry(router1_.ip_address, kGroupName1));
+  EXPECT_FALSE(cache.HasEntry(node3_.ip_address, kGroupName1));
+
+  // Demote Router 1 to a regular node.
+  router1_.is_router = false;
+  EXPECT_TRUE(cache.InsertEntry(kGroupName1, router1_, now_));
+  EXPECT_FALSE(
+      cache.GetInterfaceRouter(kUpsteamInterface2, kGroupName1, &entry));
+
+  // The refreshed expiry time is the one that is used.
+  EXPECT_TRUE(cache.InsertEntry(kGroupName1, router1_, now_ + kLargeTimeDiff2));
+  cache.ClearExpired(now_ + kLargeTimeDiff1);
+  EXPECT_TRUE(cache.HasEntry(router1_.ip_address, kGroupName1));
+  EXPECT_FALSE(cache.HasEntry(node1_.ip_address, kGroupName1));
+}
+
 TEST_F(NeighborCacheTest, InvalidInsertion) {
   NeighborCache cache;
   NeighborCacheEntry entry;
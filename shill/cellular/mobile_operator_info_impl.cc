@@ -63,6 +63,18 @@ string GetRegError(int code, const regex_t* compiled) {
   return buffer.data();
 }
 
+// Databases currently in use, keyed by the list of files they were loaded
+// from. Only weak references are kept so that a database is freed along with
+// the last MobileOperatorInfoImpl using it.
+using LoadedDatabaseMap =
+    std::map<vector<FilePath>,
+             std::weak_ptr<const MobileOperatorInfoImpl::Database>>;
+
+LoadedDatabaseMap* GetLoadedDatabases() {
+  static LoadedDatabaseMap* loaded_databases = new LoadedDatabaseMap();
+  return loaded_databases;
+}
+
 string GetApnAuthentication(const MobileAPN& apn) {
   if (apn.has_authentication()) {
     switch (apn.authentication()) {
@@ -118,8 +130,29 @@ void MobileOperatorInfoImpl::AddDatabasePath(const FilePath& absolute_path) {
 
 bool MobileOperatorInfoImpl::Init() {
   // |database_| is guaranteed to be set once |Init| is called.
-  database_.reset(new MobileOperatorDB());
+  database_ = LoadDatabase();
+  if (!database_) {
+    LOG(ERROR) << "Could not read any mobile operator database. "
+               << "Will not be able to determine MVNO.";
+    database_ = std::make_shared<Database>();
+    return false;
+  }
+  return true;
+}
 
+std::shared_ptr<const MobileOperatorInfoImpl::Database>
+MobileOperatorInfoImpl::LoadDatabase() const {
+  // Every Cellular device creates several MobileOperatorInfo objects for the
+  // same database files, so share the parsed result between them.
+  LoadedDatabaseMap* loaded_databases = GetLoadedDatabases();
+  std::shared_ptr<const Database> loaded =
+      (*loaded_databases)[database_paths_].lock();
+  if (loaded) {
+    SLOG(this, 2) << "Reusing already loaded mobile operator database.";
+    return loaded;
+  }
+
+  auto database = std::make_shared<Database>();
   bool found_databases = false;
   for (const auto& database_path : database_paths_) {
     const char* database_path_cstr = database_path.value().c_str();
@@ -131,29 +164,29 @@ bool MobileOperatorInfoImpl::Init() {
       continue;
     }
 
-    MobileOperatorDB database;
-    if (!database.ParseFromZeroCopyStream(database_stream.get())) {
+    // The first database is parsed in place; only later ones need to be
+    // collated into it.
+    MobileOperatorDB parsed_database;
+    MobileOperatorDB* target =
+        found_databases ? &parsed_database : &database->db;
+    if (!target->ParseFromZeroCopyStream(database_stream.get())) {
       LOG(ERROR) << "Could not parse mobile operator database: "
                  << database_path_cstr;
+      target->Clear();
       continue;
     }
     LOG(INFO) << "Successfully loaded database: " << database_path_cstr;
-    // Collate loaded databases into one as they're found.
-    // TODO(pprabhu) This merge might be very costly. Determine if we need to
-    // implement move semantics / bias the merge to use the largest database
-    // as the base database and merge other databases into it.
-    database_->MergeFrom(database);
+    if (found_databases)
+      database->db.MergeFrom(parsed_database);
     found_databases = true;
   }
 
-  if (!found_databases) {
-    LOG(ERROR) << "Could not read any mobile operator database. "
-               << "Will not be able to determine MVNO.";
-    return false;
-  }
+  if (!found_databases)
+    return nullptr;
 
-  PreprocessDatabase();
-  return true;
+  PreprocessDatabase(database.get());
+  (*loaded_databases)[database_paths_] = database;
+  return database;
 }
 
 void MobileOperatorInfoImpl::AddObserver(
@@ -348,10 +381,10 @@ void MobileOperatorInfoImpl::UpdateOperatorName(const string& operator_name) {
   HandleOperatorNameUpdate();
 
   // We must update the candidates by name anyway.
-  StringToMNOListMap::const_iterator cit = name_to_mnos_.find(
+  StringToMNOListMap::const_iterator cit = database_->name_to_mnos.find(
       NormalizeOperatorName(operator_name));
   candidates_by_name_.clear();
-  if (cit != name_to_mnos_.end()) {
+  if (cit != database_->name_to_mnos.end()) {
     candidates_by_name_ = cit->second;
     // We should never have inserted an empty vector into the map.
     DCHECK(!candidates_by_name_.empty());
@@ -417,14 +450,14 @@ void MobileOperatorInfoImpl::Reset() {
   }
 }
 
-void MobileOperatorInfoImpl::PreprocessDatabase() {
+void MobileOperatorInfoImpl::PreprocessDatabase(Database* database) const {
   SLOG(this, 3) << __func__;
 
-  mccmnc_to_mnos_.clear();
-  sid_to_mnos_.clear();
-  name_to_mnos_.clear();
+  database->mccmnc_to_mnos.clear();
+  database->sid_to_mnos.clear();
+  database->name_to_mnos.clear();
 
-  const RepeatedPtrField<MobileNetworkOperator>& mnos = database_->mno();
+  const RepeatedPtrField<MobileNetworkOperator>& mnos = database->db.mno();
   for (const auto& mno : mnos) {
     // MobileNetworkOperator::data is a required field.
     DCHECK(mno.has_data());
@@ -432,12 +465,12 @@ void MobileOperatorInfoImpl::PreprocessDatabase() {
 
     const RepeatedPtrField<string>& mccmncs = data.mccmnc();
     for (const auto& mccmnc : mccmncs) {
-      InsertIntoStringToMNOListMap(&mccmnc_to_mnos_, mccmnc, &mno);
+      InsertIntoStringToMNOListMap(&database->mccmnc_to_mnos, mccmnc, &mno);
     }
 
     const RepeatedPtrField<string>& sids = data.sid();
     for (const auto& sid : sids) {
-      InsertIntoStringToMNOListMap(&sid_to_mnos_, sid, &mno);
+      InsertIntoStringToMNOListMap(&database->sid_to_mnos, sid, &mno);
     }
 
     const RepeatedPtrField<LocalizedName>& localized_names =
@@ -445,7 +478,7 @@ void MobileOperatorInfoImpl::PreprocessDatabase() {
     for (const auto& localized_name : localized_names) {
       // LocalizedName::name is a required field.
       DCHECK(localized_name.has_name());
-      InsertIntoStringToMNOListMap(&name_to_mnos_,
+      InsertIntoStringToMNOListMap(&database->name_to_mnos,
                                    NormalizeOperatorName(localized_name.name()),
                                    &mno);
     }
@@ -458,7 +491,7 @@ void MobileOperatorInfoImpl::PreprocessDatabase() {
 void MobileOperatorInfoImpl::InsertIntoStringToMNOListMap(
     StringToMNOListMap* table,
     const string& key,
-    const MobileNetworkOperator* value) {
+    const MobileNetworkOperator* value) const {
   (*table)[key].push_back(value);
 }
 
@@ -471,8 +504,9 @@ bool MobileOperatorInfoImpl::AppendToCandidatesByMCCMNC(const string& mccmnc) {
   }
 
   operator_code_type_ = kOperatorCodeTypeMCCMNC;
-  StringToMNOListMap::const_iterator cit = mccmnc_to_mnos_.find(mccmnc);
-  if (cit == mccmnc_to_mnos_.end()) {
+  StringToMNOListMap::const_iterator cit =
+      database_->mccmnc_to_mnos.find(mccmnc);
+  if (cit == database_->mccmnc_to_mnos.end()) {
     LOG(WARNING) << "Unknown MCCMNC value [" << mccmnc << "].";
     return false;
   }
@@ -494,8 +528,8 @@ bool MobileOperatorInfoImpl::AppendToCandidatesBySID(const string& sid) {
   }
 
   operator_code_type_ = kOperatorCodeTypeSID;
-  StringToMNOListMap::const_iterator cit = sid_to_mnos_.find(sid);
-  if (cit == sid_to_mnos_.end()) {
+  StringToMNOListMap::const_iterator cit = database_->sid_to_mnos.find(sid);
+  if (cit == database_->sid_to_mnos.end()) {
     LOG(WARNING) << "Unknown SID value [" << sid << "].";
     return false;
   }
@@ -629,7 +663,7 @@ bool MobileOperatorInfoImpl::UpdateMVNO() {
   SLOG(this, 3) << __func__;
 
   vector<const MobileVirtualNetworkOperator*> candidate_mvnos;
-  for (const auto& mvno : database_->mvno()) {
+  for (const auto& mvno : database_->db.mvno()) {
     candidate_mvnos.push_back(&mvno);
   }
   if (current_mno_) {
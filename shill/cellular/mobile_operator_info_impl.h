@@ -27,6 +27,16 @@ class MobileOperatorInfoImpl {
       std::map<std::string,
                std::vector<const mobile_operator_db::MobileNetworkOperator*>>;
 
+  // A loaded database together with the lookup tables built from it. The
+  // lookup tables point into |db|. Instances that load the same list of
+  // database files share one copy; see LoadDatabase().
+  struct Database {
+    mobile_operator_db::MobileOperatorDB db;
+    StringToMNOListMap mccmnc_to_mnos;
+    StringToMNOListMap sid_to_mnos;
+    StringToMNOListMap name_to_mnos;
+  };
+
   // Delegates to private constructor
   MobileOperatorInfoImpl(EventDispatcher* dispatcher,
                          const std::string& info_owner);
@@ -91,14 +101,18 @@ class MobileOperatorInfoImpl {
 
   // ///////////////////////////////////////////////////////////////////////////
   // Functions.
-  void PreprocessDatabase();
+  // Returns the database loaded from |database_paths_|, reusing the copy held
+  // by another instance if there is one. Returns nullptr if none of the files
+  // could be loaded.
+  std::shared_ptr<const Database> LoadDatabase() const;
+  void PreprocessDatabase(Database* database) const;
   // This function assumes that duplicate |values| are never inserted for the
   // same |key|. If you do that, the function is too dumb to deduplicate the
   // |value|s, and two copies will get stored.
   void InsertIntoStringToMNOListMap(
       StringToMNOListMap* table,
       const std::string& key,
-      const mobile_operator_db::MobileNetworkOperator* value);
+      const mobile_operator_db::MobileNetworkOperator* value) const;
 
   bool UpdateMNO();
   bool UpdateMVNO();
@@ -144,8 +158,8 @@ class MobileOperatorInfoImpl {
   void HandleOnlinePortalUpdate();
 
   // Accessor functions for testing purpose only.
-  mobile_operator_db::MobileOperatorDB* database() {
-    return database_.get();
+  const mobile_operator_db::MobileOperatorDB* database() const {
+    return &database_->db;
   }
 
   // ///////////////////////////////////////////////////////////////////////////
@@ -165,10 +179,7 @@ class MobileOperatorInfoImpl {
   base::ObserverList<MobileOperatorInfo::Observer> observers_;
   base::CancelableClosure notify_operator_changed_task_;
 
-  std::unique_ptr<mobile_operator_db::MobileOperatorDB> database_;
-  StringToMNOListMap mccmnc_to_mnos_;
-  StringToMNOListMap sid_to_mnos_;
-  StringToMNOListMap name_to_mnos_;
+  std::shared_ptr<const Database> database_;
 
   // |candidates_by_operator_code| can be determined either using MCCMNC or
   // using SID.  At any one time, we only expect one of these operator codes to
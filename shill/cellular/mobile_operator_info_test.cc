@@ -121,6 +121,10 @@ class MobileOperatorInfoInitTest : public Test {
     return operator_info_impl_->database();
   }
 
+  const MobileOperatorDB* GetDatabase(MobileOperatorInfo* operator_info) {
+    return operator_info->impl()->database();
+  }
+
   EventDispatcherForTest dispatcher_;
   vector<FilePath> tmp_db_paths_;
   std::unique_ptr<MobileOperatorInfo> operator_info_;
@@ -187,6 +191,21 @@ TEST_F(MobileOperatorInfoInitTest, MultipleDBInit) {
   EXPECT_GT(GetDatabase()->mvno_size(), 0);
 }
 
+TEST_F(MobileOperatorInfoInitTest, SharedDatabase) {
+  // - Initialize two objects with the same database file.
+  // - Verify that the database is loaded only once and shared between them.
+  operator_info_->ClearDatabasePaths();
+  AddDatabase(mobile_operator_db::init_test_successful_init,
+              arraysize(mobile_operator_db::init_test_successful_init));
+  EXPECT_TRUE(operator_info_->Init());
+
+  MobileOperatorInfo other_operator_info(&dispatcher_, "OtherOperator");
+  other_operator_info.ClearDatabasePaths();
+  other_operator_info.AddDatabasePath(tmp_db_paths_.back());
+  EXPECT_TRUE(other_operator_info.Init());
+  EXPECT_EQ(GetDatabase(), GetDatabase(&other_operator_info));
+}
+
 TEST_F(MobileOperatorInfoInitTest, InitWithObserver) {
   // - Add an Observer.
   // - Initialize the object with empty database file.
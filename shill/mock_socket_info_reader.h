@@ -22,6 +22,8 @@ class MockSocketInfoReader : public SocketInfoReader {
   ~MockSocketInfoReader() override;
 
   MOCK_METHOD1(LoadTcpSocketInfo, bool(std::vector<SocketInfo>* info_list));
+  MOCK_METHOD1(LoadEstablishedTcpSocketInfo,
+               bool(std::vector<SocketInfo>* info_list));
 
  private:
   DISALLOW_COPY_AND_ASSIGN(MockSocketInfoReader);
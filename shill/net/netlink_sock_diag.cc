@@ -31,6 +31,7 @@ struct SockDiagRequest {
 
 SockDiagRequest CreateDumpRequest(uint8_t family,
                                   uint8_t protocol,
+                                  uint32_t states,
                                   int sequence_number) {
   CHECK(family == AF_INET || family == AF_INET6)
     << "Unsupported SOCK_DIAG family " << family;
@@ -42,7 +43,7 @@ SockDiagRequest CreateDumpRequest(uint8_t family,
   request.header.nlmsg_seq = sequence_number;
   request.req_opts.sdiag_family = family;
   request.req_opts.sdiag_protocol = protocol;
-  request.req_opts.idiag_states = -1;  // all states
+  request.req_opts.idiag_states = states;
   return request;
 }
 
@@ -143,7 +144,24 @@ bool NetlinkSockDiag::GetSockets(
     uint8_t protocol,
     std::vector<struct inet_diag_sockid>* out_socks) {
   CHECK(out_socks);
-  SockDiagRequest request = CreateDumpRequest(family, protocol,
+  std::vector<struct inet_diag_msg> msgs;
+  if (!GetSocketInfo(family, protocol, -1 /* all states */, &msgs))
+    return false;
+
+  out_socks->clear();
+  out_socks->reserve(msgs.size());
+  for (const auto& msg : msgs)
+    out_socks->push_back(msg.id);
+  return true;
+}
+
+bool NetlinkSockDiag::GetSocketInfo(
+    uint8_t family,
+    uint8_t protocol,
+    uint32_t states,
+    std::vector<struct inet_diag_msg>* out_msgs) {
+  CHECK(out_msgs);
+  SockDiagRequest request = CreateDumpRequest(family, protocol, states,
                                               ++sequence_number_);
   if (sockets_->Send(file_descriptor_,
                      static_cast<void*>(&request),
@@ -155,14 +173,14 @@ bool NetlinkSockDiag::GetSockets(
     return false;
   }
 
-  return ReadDumpContents(out_socks);
+  return ReadDumpContents(out_msgs);
 }
 
 bool NetlinkSockDiag::ReadDumpContents(
-    std::vector<struct inet_diag_sockid>* out_socks) {
+    std::vector<struct inet_diag_msg>* out_msgs) {
   char buf[8192];
 
-  out_socks->clear();
+  out_msgs->clear();
 
   for (;;) {
     ssize_t bytes_read = sockets_->RecvFrom(file_descriptor_,
@@ -199,7 +217,7 @@ bool NetlinkSockDiag::ReadDumpContents(
       case SOCK_DIAG_BY_FAMILY:
         struct inet_diag_msg current_msg;
         memcpy(&current_msg, NLMSG_DATA(nlh), sizeof(current_msg));
-        out_socks->push_back(current_msg.id);
+        out_msgs->push_back(current_msg);
         break;
       default:
         LOG(WARNING) << "Ignoring unexpected netlink message type "
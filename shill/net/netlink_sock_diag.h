@@ -16,6 +16,7 @@
 #include "shill/net/netlink_fd.h"
 #include "shill/net/shill_export.h"
 
+struct inet_diag_msg;
 struct inet_diag_sockid;
 
 namespace shill {
@@ -41,6 +42,14 @@ class SHILL_EXPORT NetlinkSockDiag {
   // make another connection.
   bool DestroySockets(uint8_t protocol, const IPAddress& saddr);
 
+  // Dumps the sockets matching the |family| and |protocol| given whose state
+  // is in |states|, a bitmask of (1 << TCP_*) values. Filtering by state is
+  // done by the kernel, so sockets in other states are never copied out.
+  bool GetSocketInfo(uint8_t family,
+                     uint8_t protocol,
+                     uint32_t states,
+                     std::vector<struct inet_diag_msg>* out_msgs);
+
  private:
   // Hidden; use the static Create function above.
   NetlinkSockDiag(std::unique_ptr<Sockets> sockets, int file_descriptor);
@@ -51,7 +60,7 @@ class SHILL_EXPORT NetlinkSockDiag {
                   std::vector<struct inet_diag_sockid>* out_socks);
 
   // Read the socket dump from the netlink socket.
-  bool ReadDumpContents(std::vector<struct inet_diag_sockid>* out_socks);
+  bool ReadDumpContents(std::vector<struct inet_diag_msg>* out_msgs);
 
   std::unique_ptr<Sockets> sockets_;
   int file_descriptor_;
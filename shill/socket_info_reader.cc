@@ -4,6 +4,11 @@
 
 #include "shill/socket_info_reader.h"
 
+#include <arpa/inet.h>
+#include <linux/inet_diag.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
 #include <algorithm>
 #include <limits>
 
@@ -13,6 +18,7 @@
 
 #include "shill/file_reader.h"
 #include "shill/logging.h"
+#include "shill/net/sockets.h"
 
 using base::FilePath;
 using std::string;
@@ -32,7 +38,7 @@ const char kTcpv6SocketInfoFilePath[] = "/proc/net/tcp6";
 
 }  // namespace
 
-SocketInfoReader::SocketInfoReader() {}
+SocketInfoReader::SocketInfoReader() : sock_diag_failed_(false) {}
 
 SocketInfoReader::~SocketInfoReader() {}
 
@@ -53,6 +59,109 @@ bool SocketInfoReader::LoadTcpSocketInfo(vector<SocketInfo>* info_list) {
   return v4_loaded || v6_loaded;
 }
 
+bool SocketInfoReader::LoadEstablishedTcpSocketInfo(
+    vector<SocketInfo>* info_list) {
+  info_list->clear();
+  if (!sock_diag_ && !sock_diag_failed_) {
+    sock_diag_ = CreateNetlinkSockDiag();
+    sock_diag_failed_ = !sock_diag_;
+  }
+
+  if (sock_diag_) {
+    bool v4_loaded = AppendSockDiagSocketInfo(AF_INET, info_list);
+    bool v6_loaded = AppendSockDiagSocketInfo(AF_INET6, info_list);
+    if (v4_loaded || v6_loaded)
+      return true;
+
+    LOG(WARNING) << "sock_diag dump failed; falling back to procfs.";
+    sock_diag_.reset();
+    sock_diag_failed_ = true;
+    info_list->clear();
+  }
+
+  if (!LoadTcpSocketInfo(info_list))
+    return false;
+  info_list->erase(
+      std::remove_if(info_list->begin(), info_list->end(),
+                     [](const SocketInfo& info) {
+                       return info.connection_state !=
+                              SocketInfo::kConnectionStateEstablished;
+                     }),
+      info_list->end());
+  return true;
+}
+
+std::unique_ptr<NetlinkSockDiag> SocketInfoReader::CreateNetlinkSockDiag() {
+  return NetlinkSockDiag::Create(std::make_unique<Sockets>());
+}
+
+bool SocketInfoReader::AppendSockDiagSocketInfo(
+    uint8_t family, vector<SocketInfo>* info_list) {
+  vector<struct inet_diag_msg> msgs;
+  if (!sock_diag_->GetSocketInfo(family, IPPROTO_TCP, 1 << TCP_ESTABLISHED,
+                                 &msgs)) {
+    SLOG(this, 2) << __func__ << ": Failed to dump sockets of family "
+                  << static_cast<int>(family) << ".";
+    return false;
+  }
+
+  info_list->reserve(info_list->size() + msgs.size());
+  for (const auto& msg : msgs) {
+    SocketInfo socket_info;
+    if (ParseInetDiagMsg(msg, &socket_info))
+      info_list->push_back(socket_info);
+  }
+  return true;
+}
+
+bool SocketInfoReader::ParseInetDiagMsg(const struct inet_diag_msg& msg,
+                                        SocketInfo* socket_info) {
+  IPAddress::Family family;
+  if (msg.idiag_family == AF_INET) {
+    family = IPAddress::kFamilyIPv4;
+  } else if (msg.idiag_family == AF_INET6) {
+    family = IPAddress::kFamilyIPv6;
+  } else {
+    return false;
+  }
+
+  // Unlike procfs, sock_diag reports addresses and ports in network order.
+  const size_t address_length = IPAddress::GetAddressLength(family);
+  SocketInfo info;
+  info.local_ip_address = IPAddress(
+      family,
+      ByteString(reinterpret_cast<const unsigned char*>(msg.id.idiag_src),
+                 address_length));
+  info.local_port = ntohs(msg.id.idiag_sport);
+  info.remote_ip_address = IPAddress(
+      family,
+      ByteString(reinterpret_cast<const unsigned char*>(msg.id.idiag_dst),
+                 address_length));
+  info.remote_port = ntohs(msg.id.idiag_dport);
+
+  // For TCP the queue values have the same meaning as the tx_queue and
+  // rx_queue columns of /proc/net/tcp.
+  info.transmit_queue_value = msg.idiag_wqueue;
+  info.receive_queue_value = msg.idiag_rqueue;
+
+  if (msg.idiag_state > 0 &&
+      msg.idiag_state < SocketInfo::kConnectionStateMax) {
+    info.connection_state =
+        static_cast<SocketInfo::ConnectionState>(msg.idiag_state);
+  } else {
+    info.connection_state = SocketInfo::kConnectionStateUnknown;
+  }
+
+  if (msg.idiag_timer < SocketInfo::kTimerStateMax) {
+    info.timer_state = static_cast<SocketInfo::TimerState>(msg.idiag_timer);
+  } else {
+    info.timer_state = SocketInfo::kTimerStateUnknown;
+  }
+
+  *socket_info = info;
+  return true;
+}
+
 bool SocketInfoReader::AppendSocketInfo(const FilePath& info_file_path,
                                         vector<SocketInfo>* info_list) {
   FileReader file_reader;
@@ -5,6 +5,7 @@
 #ifndef SHILL_SOCKET_INFO_READER_H_
 #define SHILL_SOCKET_INFO_READER_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -12,8 +13,11 @@
 #include <base/macros.h>
 #include <gtest/gtest_prod.h>
 
+#include "shill/net/netlink_sock_diag.h"
 #include "shill/socket_info.h"
 
+struct inet_diag_msg;
+
 namespace shill {
 
 class SocketInfoReader {
@@ -36,11 +40,23 @@ class SocketInfoReader {
   // if when neither /proc/net/tcp nor /proc/net/tcp6 can be read.
   virtual bool LoadTcpSocketInfo(std::vector<SocketInfo>* info_list);
 
+  // Loads information about established TCP sockets. A netlink sock_diag dump
+  // is used when available since it is filtered by the kernel and needs no
+  // text parsing; otherwise falls back to LoadTcpSocketInfo(). Existing
+  // entries in |info_list| are always discarded.
+  virtual bool LoadEstablishedTcpSocketInfo(std::vector<SocketInfo>* info_list);
+
+ protected:
+  // Creates the sock_diag socket used by LoadEstablishedTcpSocketInfo().
+  // Overloaded by unit tests.
+  virtual std::unique_ptr<NetlinkSockDiag> CreateNetlinkSockDiag();
+
  private:
   FRIEND_TEST(SocketInfoReaderTest, AppendSocketInfo);
   FRIEND_TEST(SocketInfoReaderTest, ParseConnectionState);
   FRIEND_TEST(SocketInfoReaderTest, ParseIPAddress);
   FRIEND_TEST(SocketInfoReaderTest, ParseIPAddressAndPort);
+  FRIEND_TEST(SocketInfoReaderTest, ParseInetDiagMsg);
   FRIEND_TEST(SocketInfoReaderTest, ParsePort);
   FRIEND_TEST(SocketInfoReaderTest, ParseSocketInfo);
   FRIEND_TEST(SocketInfoReaderTest, ParseTimerState);
@@ -48,6 +64,10 @@ class SocketInfoReader {
 
   bool AppendSocketInfo(const base::FilePath& info_file_path,
                         std::vector<SocketInfo>* info_list);
+  bool AppendSockDiagSocketInfo(uint8_t family,
+                                std::vector<SocketInfo>* info_list);
+  bool ParseInetDiagMsg(const struct inet_diag_msg& msg,
+                        SocketInfo* socket_info);
   bool ParseSocketInfo(const std::string& input, SocketInfo* socket_info);
   bool ParseIPAddressAndPort(
       const std::string& input, IPAddress* ip_address, uint16_t* port);
@@ -61,6 +81,11 @@ class SocketInfoReader {
   bool ParseTimerState(const std::string& input,
                        SocketInfo::TimerState* timer_state);
 
+  std::unique_ptr<NetlinkSockDiag> sock_diag_;
+  // Set once sock_diag turned out to be unusable, so that later calls go
+  // straight to procfs.
+  bool sock_diag_failed_;
+
   DISALLOW_COPY_AND_ASSIGN(SocketInfoReader);
 };
 
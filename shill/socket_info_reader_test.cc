@@ -4,8 +4,16 @@
 
 #include "shill/socket_info_reader.h"
 
+#include <arpa/inet.h>
+#include <linux/inet_diag.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include <memory>
+
 #include <base/files/file_util.h>
 #include <base/files/scoped_temp_dir.h>
+#include <base/macros.h>
 #include <base/strings/stringprintf.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -57,6 +65,11 @@ class SocketInfoReaderUnderTest : public SocketInfoReader {
   // in procfs (i.e. /proc/net/tcp and /proc/net/tcp6).
   MOCK_CONST_METHOD0(GetTcpv4SocketInfoFilePath, FilePath());
   MOCK_CONST_METHOD0(GetTcpv6SocketInfoFilePath, FilePath());
+
+  // Pretend sock_diag is unavailable so that procfs is always used.
+  std::unique_ptr<NetlinkSockDiag> CreateNetlinkSockDiag() override {
+    return nullptr;
+  }
 };
 
 class SocketInfoReaderTest : public testing::Test {
@@ -154,6 +167,33 @@ TEST_F(SocketInfoReaderTest, LoadTcpSocketInfo) {
   ExpectSocketInfoEqual(v6_info, info_list[1]);
 }
 
+TEST_F(SocketInfoReaderTest, LoadEstablishedTcpSocketInfoFromProcfs) {
+  FilePath invalid_path("/non-existent-file"), v4_path;
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  CreateSocketInfoFile(kIPv4SocketInfoLines, arraysize(kIPv4SocketInfoLines),
+                       temp_dir.GetPath(), &v4_path);
+
+  SocketInfo v4_info(SocketInfo::kConnectionStateEstablished,
+                     StringToIPv4Address(kIPv4Address_192_168_1_10),
+                     80,
+                     StringToIPv4Address(kIPv4Address_127_0_0_1),
+                     1020,
+                     0,
+                     0,
+                     SocketInfo::kTimerStateNoTimerPending);
+
+  // Only the established socket is kept; the listening one is dropped.
+  vector<SocketInfo> info_list;
+  EXPECT_CALL(reader_, GetTcpv4SocketInfoFilePath())
+      .WillOnce(Return(v4_path));
+  EXPECT_CALL(reader_, GetTcpv6SocketInfoFilePath())
+      .WillOnce(Return(invalid_path));
+  EXPECT_TRUE(reader_.LoadEstablishedTcpSocketInfo(&info_list));
+  EXPECT_EQ(1, info_list.size());
+  ExpectSocketInfoEqual(v4_info, info_list[0]);
+}
+
 TEST_F(SocketInfoReaderTest, AppendSocketInfo) {
   FilePath file_path("/non-existent-file");
   vector<SocketInfo> info_list;
@@ -276,6 +316,47 @@ TEST_F(SocketInfoReaderTest, ParseIPAddressAndPort) {
   EXPECT_EQ(8080, port);
 }
 
+TEST_F(SocketInfoReaderTest, ParseInetDiagMsg) {
+  SocketInfo info;
+  struct inet_diag_msg msg;
+  memset(&msg, 0, sizeof(msg));
+
+  msg.idiag_family = AF_UNIX;
+  EXPECT_FALSE(reader_.ParseInetDiagMsg(msg, &info));
+
+  const IPAddress local = StringToIPv4Address(kIPv4Address_192_168_1_10);
+  const IPAddress remote = StringToIPv4Address(kIPv4Address_127_0_0_1);
+  msg.idiag_family = AF_INET;
+  msg.idiag_state = SocketInfo::kConnectionStateEstablished;
+  msg.idiag_timer = SocketInfo::kTimerStateRetransmitTimerPending;
+  msg.idiag_wqueue = 10;
+  msg.idiag_rqueue = 5;
+  msg.id.idiag_sport = htons(80);
+  msg.id.idiag_dport = htons(1020);
+  memcpy(msg.id.idiag_src, local.GetConstData(), local.GetLength());
+  memcpy(msg.id.idiag_dst, remote.GetConstData(), remote.GetLength());
+  SocketInfo expected_info(SocketInfo::kConnectionStateEstablished,
+                           local,
+                           80,
+                           remote,
+                           1020,
+                           10,
+                           5,
+                           SocketInfo::kTimerStateRetransmitTimerPending);
+  EXPECT_TRUE(reader_.ParseInetDiagMsg(msg, &info));
+  ExpectSocketInfoEqual(expected_info, info);
+
+  const IPAddress local6 = StringToIPv6Address(kIPv6AddressPattern1);
+  msg.idiag_family = AF_INET6;
+  msg.idiag_state = 0xff;
+  msg.idiag_timer = 0xff;
+  memcpy(msg.id.idiag_src, local6.GetConstData(), local6.GetLength());
+  EXPECT_TRUE(reader_.ParseInetDiagMsg(msg, &info));
+  EXPECT_TRUE(info.local_ip_address.Equals(local6));
+  EXPECT_EQ(SocketInfo::kConnectionStateUnknown, info.connection_state);
+  EXPECT_EQ(SocketInfo::kTimerStateUnknown, info.timer_state);
+}
+
 TEST_F(SocketInfoReaderTest, ParseIPAddress) {
   IPAddress ip_address(IPAddress::kFamilyUnknown);
 
@@ -104,7 +104,7 @@ void TrafficMonitor::BuildIPPortToTxQueueLength(
 bool TrafficMonitor::IsCongestedTxQueues() {
   SLOG(device_.get(), 4) << __func__;
   vector<SocketInfo> socket_infos;
-  if (!socket_info_reader_->LoadTcpSocketInfo(&socket_infos) ||
+  if (!socket_info_reader_->LoadEstablishedTcpSocketInfo(&socket_infos) ||
       socket_infos.empty()) {
     SLOG(device_.get(), 3) << __func__ << ": Empty socket info";
     ResetCongestedTxQueuesStatsWithLogging();
@@ -92,7 +92,7 @@ class TrafficMonitorTest : public Test {
 
   void SetupMockSocketInfos(const vector<SocketInfo>& socket_infos) {
     mock_socket_infos_ = socket_infos;
-    EXPECT_CALL(*mock_socket_info_reader_, LoadTcpSocketInfo(_))
+    EXPECT_CALL(*mock_socket_info_reader_, LoadEstablishedTcpSocketInfo(_))
         .WillRepeatedly(
             Invoke(this, &TrafficMonitorTest::MockLoadTcpSocketInfo));
   }
@@ -28,6 +28,7 @@ const char kDetachUsbDeviceMethod[] = "DetachUsbDevice";
 const char kListUsbDeviceMethod[] = "ListUsbDevices";
 
 const char kContainerStartupFailedSignal[] = "ContainerStartupFailed";
+const char kExportDiskImageProgressSignal[] = "ExportDiskImageProgress";
 
 }  // namespace concierge
 }  // namespace vm_tools
@@ -27,6 +27,7 @@
 #include <trunks/policy_session.h>
 #include <trunks/scoped_global_session.h>
 #include <trunks/tpm_constants.h>
+#include <trunks/tpm_generated.h>
 #include <trunks/tpm_utility.h>
 #include <trunks/tpm_utility_impl.h>
 
@@ -170,6 +171,7 @@ NvramResult Tpm2NvramImpl::DefineSpace(
                           &world_write_allowed)) {
     return NVRAM_RESULT_INVALID_PARAMETER;
   }
+  space_cache_.erase(index);
   NvramPolicyRecord policy_record;
   policy_record.set_index(index);
   policy_record.set_policy(policy);
@@ -217,6 +219,7 @@ NvramResult Tpm2NvramImpl::DestroySpace(uint32_t index) {
   if (!SetupOwnerSession()) {
     return NVRAM_RESULT_OPERATION_DISABLED;
   }
+  space_cache_.erase(index);
   TPM_RC result =
       trunks_utility_->DestroyNVSpace(index, trunks_session_->GetDelegate());
   if (result != TPM_RC_SUCCESS) {
@@ -243,6 +246,7 @@ NvramResult Tpm2NvramImpl::WriteSpace(uint32_t index,
   if (nvram_public.attributes & trunks::TPMA_NV_WRITELOCKED) {
     return NVRAM_RESULT_OPERATION_DISABLED;
   }
+  space_cache_.erase(index);
   NvIndexAuthenticator nvindex_auth(tpm_status_, &trunks_session_,
       trunks_factory_);
   trunks::AuthorizationDelegate* authorization = nullptr;
@@ -309,6 +313,23 @@ NvramResult Tpm2NvramImpl::ReadSpace(uint32_t index,
     *data = std::string(nvram_public.data_size, 0);
     return NVRAM_RESULT_SUCCESS;
   }
+  // A cached entry is only served while the public area reported by trunks
+  // still matches the one it was read with. trunks memoizes public areas, so
+  // this does not detect an index redefined outside tpm_manager; the cache
+  // relies on only tpm_manager destroying write-locked spaces.
+  std::string public_area;
+  const bool cacheable =
+      IsSpaceCacheable(nvram_public) &&
+      trunks::Serialize_TPMS_NV_PUBLIC(nvram_public, &public_area) ==
+          TPM_RC_SUCCESS;
+  if (cacheable) {
+    auto it = space_cache_.find(index);
+    if (it != space_cache_.end() && it->second.public_area == public_area &&
+        it->second.authorization_value == authorization_value) {
+      *data = it->second.data;
+      return NVRAM_RESULT_SUCCESS;
+    }
+  }
   NvIndexAuthenticator nvindex_auth(tpm_status_, &trunks_session_,
       trunks_factory_);
   trunks::AuthorizationDelegate* authorization = nullptr;
@@ -347,6 +368,12 @@ NvramResult Tpm2NvramImpl::ReadSpace(uint32_t index,
     LOG(ERROR) << "Error reading nvram space: " << GetErrorString(result);
     return MapTpmError(result);
   }
+  if (cacheable) {
+    CachedSpace& cached_space = space_cache_[index];
+    cached_space.public_area = public_area;
+    cached_space.authorization_value = authorization_value;
+    cached_space.data = *data;
+  }
   return NVRAM_RESULT_SUCCESS;
 }
 
@@ -379,6 +406,7 @@ NvramResult Tpm2NvramImpl::LockSpace(uint32_t index,
     // Already locked.
     return NVRAM_RESULT_SUCCESS;
   }
+  space_cache_.erase(index);
   // Handle locking read and write separately because the authorization might be
   // different.
   if (lock_read && !is_read_locked) {
@@ -504,6 +532,19 @@ NvramResult Tpm2NvramImpl::GetSpaceInfo(
   return NVRAM_RESULT_SUCCESS;
 }
 
+// static
+bool Tpm2NvramImpl::IsSpaceCacheable(
+    const trunks::TPMS_NV_PUBLIC& nvram_public) {
+  // Spaces that are not write-locked may still change. Boot read-lockable
+  // spaces may be read-locked by another TPM client at any time, policy reads
+  // may depend on PCR values, and owner reads stop working once the owner
+  // password has been dropped, so those are always read from the TPM.
+  return (nvram_public.attributes & trunks::TPMA_NV_WRITELOCKED) &&
+         !(nvram_public.attributes &
+           (trunks::TPMA_NV_READ_STCLEAR | trunks::TPMA_NV_POLICYREAD |
+            trunks::TPMA_NV_OWNERREAD));
+}
+
 bool Tpm2NvramImpl::Initialize() {
 #ifndef TRUNKS_USE_PER_OP_SESSIONS
   if (initialized_) {
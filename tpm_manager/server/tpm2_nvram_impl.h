@@ -19,6 +19,7 @@
 
 #include "tpm_manager/server/tpm_nvram.h"
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -114,12 +115,31 @@ class Tpm2NvramImpl : public TpmNvram {
   // Best effort delete of the policy |record| for |index|.
   void DeletePolicyRecord(uint32_t index);
 
+  // Returns true if the contents of a space with |nvram_public| can be served
+  // from |space_cache_|, i.e. they can no longer change and reading them
+  // requires only the authorization value of the space.
+  static bool IsSpaceCacheable(const trunks::TPMS_NV_PUBLIC& nvram_public);
+
+  // The contents of a space as read with a given authorization value, and the
+  // serialized public area of the space at the time.
+  struct CachedSpace {
+    std::string public_area;
+    std::string authorization_value;
+    std::string data;
+  };
+
   const trunks::TrunksFactory& trunks_factory_;
   LocalDataStore* local_data_store_;
   TpmStatus* tpm_status_;
   bool initialized_;
   std::unique_ptr<trunks::HmacSession> trunks_session_;
   std::unique_ptr<trunks::TpmUtility> trunks_utility_;
+  // Contents of cacheable spaces that have been read, keyed by index. An entry
+  // is only served for the same authorization value that read it, and is
+  // dropped whenever this class changes the space. A hit sends no command to
+  // the TPM, so this assumes that only tpm_manager destroys or redefines
+  // write-locked spaces.
+  std::map<uint32_t, CachedSpace> space_cache_;
 
   friend class Tpm2NvramTest;
   DISALLOW_COPY_AND_ASSIGN(Tpm2NvramImpl);
@@ -159,6 +159,39 @@ class Tpm2NvramTest : public testing::Test {
     }
   }
 
+  // Sets up a written and write-locked space that cannot be read-locked, so
+  // its contents may be cached. Returns the public area of the space.
+  trunks::TPMS_NV_PUBLIC SetupLockedSpace(uint32_t index,
+                                          uint32_t size,
+                                          AuthType auth_type) {
+    SetupExistingSpace(index, size,
+                       trunks::TPMA_NV_WRITTEN | trunks::TPMA_NV_WRITELOCKED,
+                       EXPECT_AUTH, auth_type);
+    trunks::TPMS_NV_PUBLIC public_data = {};
+    public_data.nv_index = index;
+    public_data.name_alg = trunks::TPM_ALG_SHA256;
+    public_data.data_size = size;
+    public_data.attributes = trunks::TPMA_NV_WRITE_STCLEAR |
+                             trunks::TPMA_NV_WRITTEN |
+                             trunks::TPMA_NV_WRITELOCKED;
+    if (auth_type == OWNER_AUTH) {
+      public_data.attributes |=
+          trunks::TPMA_NV_OWNERREAD | trunks::TPMA_NV_OWNERWRITE;
+    } else {
+      public_data.attributes |=
+          trunks::TPMA_NV_AUTHREAD | trunks::TPMA_NV_AUTHWRITE;
+    }
+    SetupPublicArea(public_data);
+    return public_data;
+  }
+
+  void SetupPublicArea(const trunks::TPMS_NV_PUBLIC& public_data) {
+    ON_CALL(mock_tpm_utility_,
+            GetNVSpacePublicArea(public_data.nv_index, _))
+        .WillByDefault(
+            DoAll(SetArgPointee<1>(public_data), Return(TPM_RC_SUCCESS)));
+  }
+
  protected:
   const std::string kSomeData{"data"};
   trunks::TrunksFactoryForTest factory_;
@@ -485,6 +518,115 @@ TEST_F(Tpm2NvramTest, ReadSpaceSuccess) {
   EXPECT_EQ(kSomeData, read_data);
 }
 
+TEST_F(Tpm2NvramTest, ReadSpaceWriteLockedIsCached) {
+  SetupOwnerPassword();
+  SetupLockedSpace(kSomeNvramIndex, kSomeData.size(), NORMAL_AUTH);
+  EXPECT_CALL(mock_tpm_utility_,
+              ReadNVSpace(kSomeNvramIndex, 0, kSomeData.size(), false, _,
+                          kHMACAuth))
+      .WillOnce(DoAll(SetArgPointee<4>(kSomeData), Return(TPM_RC_SUCCESS)));
+  std::string read_data;
+  EXPECT_EQ(NVRAM_RESULT_SUCCESS,
+            tpm_nvram_->ReadSpace(kSomeNvramIndex, &read_data,
+                                  kFakeAuthorizationValue));
+  EXPECT_EQ(kSomeData, read_data);
+  read_data.clear();
+  EXPECT_EQ(NVRAM_RESULT_SUCCESS,
+            tpm_nvram_->ReadSpace(kSomeNvramIndex, &read_data,
+                                  kFakeAuthorizationValue));
+  EXPECT_EQ(kSomeData, read_data);
+}
+
+TEST_F(Tpm2NvramTest, ReadSpaceCacheMissOnOtherAuthorization) {
+  constexpr char kOtherAuthorizationValue[] = "other_authorization";
+  SetupOwnerPassword();
+  SetupLockedSpace(kSomeNvramIndex, kSomeData.size(), NORMAL_AUTH);
+  EXPECT_CALL(mock_hmac_session_,
+              SetEntityAuthorizationValue(kOtherAuthorizationValue))
+      .Times(AtLeast(1));
+  EXPECT_CALL(mock_tpm_utility_,
+              ReadNVSpace(kSomeNvramIndex, 0, kSomeData.size(), false, _,
+                          kHMACAuth))
+      .Times(2)
+      .WillRepeatedly(
+          DoAll(SetArgPointee<4>(kSomeData), Return(TPM_RC_SUCCESS)));
+  std::string read_data;
+  EXPECT_EQ(NVRAM_RESULT_SUCCESS,
+            tpm_nvram_->ReadSpace(kSomeNvramIndex, &read_data,
+                                  kFakeAuthorizationValue));
+  EXPECT_EQ(NVRAM_RESULT_SUCCESS,
+            tpm_nvram_->ReadSpace(kSomeNvramIndex, &read_data,
+                                  kOtherAuthorizationValue));
+  EXPECT_EQ(kSomeData, read_data);
+}
+
+TEST_F(Tpm2NvramTest, ReadSpaceCacheDroppedOnDestroy) {
+  SetupOwnerPassword();
+  SetupLockedSpace(kSomeNvramIndex, kSomeData.size(), NORMAL_AUTH);
+  EXPECT_CALL(mock_hmac_session_,
+              SetEntityAuthorizationValue(kTestOwnerPassword))
+      .Times(AtLeast(1));
+  EXPECT_CALL(mock_tpm_utility_, DestroyNVSpace(kSomeNvramIndex, kHMACAuth))
+      .WillOnce(Return(TPM_RC_SUCCESS));
+  EXPECT_CALL(mock_tpm_utility_,
+              ReadNVSpace(kSomeNvramIndex, 0, kSomeData.size(), false, _,
+                          kHMACAuth))
+      .Times(2)
+      .WillRepeatedly(
+          DoAll(SetArgPointee<4>(kSomeData), Return(TPM_RC_SUCCESS)));
+  std::string read_data;
+  EXPECT_EQ(NVRAM_RESULT_SUCCESS,
+            tpm_nvram_->ReadSpace(kSomeNvramIndex, &read_data,
+                                  kFakeAuthorizationValue));
+  EXPECT_EQ(NVRAM_RESULT_SUCCESS, tpm_nvram_->DestroySpace(kSomeNvramIndex));
+  EXPECT_EQ(NVRAM_RESULT_SUCCESS,
+            tpm_nvram_->ReadSpace(kSomeNvramIndex, &read_data,
+                                  kFakeAuthorizationValue));
+  EXPECT_EQ(kSomeData, read_data);
+}
+
+TEST_F(Tpm2NvramTest, ReadSpaceCacheMissOnPublicAreaChange) {
+  SetupOwnerPassword();
+  trunks::TPMS_NV_PUBLIC public_data =
+      SetupLockedSpace(kSomeNvramIndex, kSomeData.size(), NORMAL_AUTH);
+  EXPECT_CALL(mock_tpm_utility_,
+              ReadNVSpace(kSomeNvramIndex, 0, kSomeData.size(), false, _,
+                          kHMACAuth))
+      .Times(2)
+      .WillRepeatedly(
+          DoAll(SetArgPointee<4>(kSomeData), Return(TPM_RC_SUCCESS)));
+  std::string read_data;
+  EXPECT_EQ(NVRAM_RESULT_SUCCESS,
+            tpm_nvram_->ReadSpace(kSomeNvramIndex, &read_data,
+                                  kFakeAuthorizationValue));
+  // trunks reports a different public area for the index.
+  public_data.attributes |= trunks::TPMA_NV_NO_DA;
+  SetupPublicArea(public_data);
+  EXPECT_EQ(NVRAM_RESULT_SUCCESS,
+            tpm_nvram_->ReadSpace(kSomeNvramIndex, &read_data,
+                                  kFakeAuthorizationValue));
+  EXPECT_EQ(kSomeData, read_data);
+}
+
+TEST_F(Tpm2NvramTest, ReadSpaceOwnerWriteLockedNotCached) {
+  SetupOwnerPassword();
+  SetupLockedSpace(kSomeNvramIndex, kSomeData.size(), OWNER_AUTH);
+  EXPECT_CALL(mock_tpm_utility_,
+              ReadNVSpace(kSomeNvramIndex, 0, kSomeData.size(), true, _,
+                          kHMACAuth))
+      .Times(2)
+      .WillRepeatedly(
+          DoAll(SetArgPointee<4>(kSomeData), Return(TPM_RC_SUCCESS)));
+  std::string read_data;
+  EXPECT_EQ(NVRAM_RESULT_SUCCESS,
+            tpm_nvram_->ReadSpace(kSomeNvramIndex, &read_data,
+                                  kFakeAuthorizationValue));
+  EXPECT_EQ(NVRAM_RESULT_SUCCESS,
+            tpm_nvram_->ReadSpace(kSomeNvramIndex, &read_data,
+                                  kFakeAuthorizationValue));
+  EXPECT_EQ(kSomeData, read_data);
+}
+
 TEST_F(Tpm2NvramTest, ReadSpaceNonexistant) {
   EXPECT_CALL(mock_tpm_utility_, GetNVSpacePublicArea(kSomeNvramIndex, _))
       .WillRepeatedly(Return(TPM_RC_HANDLE));
@@ -50,8 +50,32 @@ std::string GetOpenSSLError() {
 
 namespace trunks {
 
+bool SaltingKeyCache::Get(std::string* modulus) const {
+  base::AutoLock lock(lock_);
+  if (modulus_.empty())
+    return false;
+  *modulus = modulus_;
+  return true;
+}
+
+void SaltingKeyCache::Set(const std::string& modulus) {
+  base::AutoLock lock(lock_);
+  modulus_ = modulus;
+}
+
+void SaltingKeyCache::Clear() {
+  base::AutoLock lock(lock_);
+  modulus_.clear();
+}
+
 SessionManagerImpl::SessionManagerImpl(const TrunksFactory& factory)
-    : factory_(factory), session_handle_(kUninitializedHandle) {
+    : SessionManagerImpl(factory, nullptr) {}
+
+SessionManagerImpl::SessionManagerImpl(const TrunksFactory& factory,
+                                       SaltingKeyCache* salting_key_cache)
+    : factory_(factory),
+      session_handle_(kUninitializedHandle),
+      salting_key_cache_(salting_key_cache) {
   crypto::EnsureOpenSSLInit();
 }
 
@@ -77,7 +101,36 @@ TPM_RC SessionManagerImpl::StartSession(
     bool salted,
     bool enable_encryption,
     HmacAuthorizationDelegate* delegate) {
+  bool used_cached_salting_key = false;
+  TPM_RC result = StartSessionInternal(
+      session_type, bind_entity, bind_authorization_value, salted,
+      enable_encryption, true /* use_cached_salting_key */,
+      &used_cached_salting_key, delegate);
+  if (result != TPM_RC_SUCCESS && used_cached_salting_key) {
+    // The salting key may have been replaced since it was cached, e.g. after
+    // the TPM was cleared. Try again with the key currently in the TPM.
+    LOG(WARNING) << "Retrying to start the session without the cached salting "
+                 << "key.";
+    salting_key_cache_->Clear();
+    result = StartSessionInternal(
+        session_type, bind_entity, bind_authorization_value, salted,
+        enable_encryption, false /* use_cached_salting_key */,
+        &used_cached_salting_key, delegate);
+  }
+  return result;
+}
+
+TPM_RC SessionManagerImpl::StartSessionInternal(
+    TPM_SE session_type,
+    TPMI_DH_ENTITY bind_entity,
+    const std::string& bind_authorization_value,
+    bool salted,
+    bool enable_encryption,
+    bool use_cached_salting_key,
+    bool* used_cached_salting_key,
+    HmacAuthorizationDelegate* delegate) {
   CHECK(delegate);
+  *used_cached_salting_key = false;
   // If we already have an active session, close it.
   CloseSession();
 
@@ -92,10 +145,16 @@ TPM_RC SessionManagerImpl::StartSession(
         reinterpret_cast<unsigned char*>(base::string_as_array(&salt));
     CHECK_EQ(RAND_bytes(salt_buffer, salt.size()), 1)
         << "Error generating a cryptographically random salt.";
+    std::string modulus;
+    TPM_RC key_result = GetSaltingKeyModulus(use_cached_salting_key, &modulus,
+                                             used_cached_salting_key);
+    if (key_result != TPM_RC_SUCCESS) {
+      return key_result;
+    }
     // First we encrypt the cryptographically secure salt using PKCS1_OAEP
     // padded RSA public key encryption. This is specified in TPM2.0
     // Part1 Architecture, Appendix B.10.2.
-    TPM_RC salt_result = EncryptSalt(salt, &encrypted_salt);
+    TPM_RC salt_result = EncryptSalt(salt, modulus, &encrypted_salt);
     if (salt_result != TPM_RC_SUCCESS) {
       LOG(ERROR) << "Error encrypting salt: " << GetErrorString(salt_result);
       return salt_result;
@@ -152,8 +211,15 @@ TPM_RC SessionManagerImpl::StartSession(
   return TPM_RC_SUCCESS;
 }
 
-TPM_RC SessionManagerImpl::EncryptSalt(const std::string& salt,
-                                       std::string* encrypted_salt) {
+TPM_RC SessionManagerImpl::GetSaltingKeyModulus(bool use_cache,
+                                                std::string* modulus,
+                                                bool* from_cache) {
+  *from_cache = false;
+  if (use_cache && salting_key_cache_ && salting_key_cache_->Get(modulus)) {
+    *from_cache = true;
+    return TPM_RC_SUCCESS;
+  }
+
   TPM2B_NAME out_name;
   TPM2B_NAME qualified_name;
   TPM2B_PUBLIC public_data;
@@ -171,6 +237,18 @@ TPM_RC SessionManagerImpl::EncryptSalt(const std::string& salt,
     LOG(ERROR) << "Invalid salting key attributes.";
     return TRUNKS_RC_SESSION_SETUP_ERROR;
   }
+  modulus->assign(
+      reinterpret_cast<const char*>(public_data.public_area.unique.rsa.buffer),
+      public_data.public_area.unique.rsa.size);
+  if (salting_key_cache_) {
+    salting_key_cache_->Set(*modulus);
+  }
+  return TPM_RC_SUCCESS;
+}
+
+TPM_RC SessionManagerImpl::EncryptSalt(const std::string& salt,
+                                       const std::string& modulus,
+                                       std::string* encrypted_salt) {
   crypto::ScopedRSA salting_key_rsa(RSA_new());
   salting_key_rsa->e = BN_new();
   if (!salting_key_rsa->e) {
@@ -179,8 +257,8 @@ TPM_RC SessionManagerImpl::EncryptSalt(const std::string& salt,
   }
   BN_set_word(salting_key_rsa->e, kWellKnownExponent);
   salting_key_rsa->n =
-      BN_bin2bn(public_data.public_area.unique.rsa.buffer,
-                public_data.public_area.unique.rsa.size, nullptr);
+      BN_bin2bn(reinterpret_cast<const uint8_t*>(modulus.data()),
+                modulus.size(), nullptr);
   if (!salting_key_rsa->n) {
     LOG(ERROR) << "Error setting public area of rsa key: " << GetOpenSSLError();
     return TRUNKS_RC_SESSION_SETUP_ERROR;
@@ -21,6 +21,8 @@
 
 #include <string>
 
+#include <base/macros.h>
+#include <base/synchronization/lock.h>
 #include <gtest/gtest_prod.h>
 
 #include "trunks/tpm_generated.h"
@@ -28,6 +30,29 @@
 
 namespace trunks {
 
+// Remembers the RSA modulus of the salting key, so that SessionManagerImpl
+// instances sharing it do not read the key back from the TPM for every salted
+// session they start. The salting key only changes when the TPM is cleared.
+// This class is thread-safe.
+class TRUNKS_EXPORT SaltingKeyCache {
+ public:
+  SaltingKeyCache() = default;
+
+  // Copies the cached modulus to |modulus| and returns true, or returns false
+  // if none is cached.
+  bool Get(std::string* modulus) const;
+
+  void Set(const std::string& modulus);
+
+  void Clear();
+
+ private:
+  mutable base::Lock lock_;
+  std::string modulus_;
+
+  DISALLOW_COPY_AND_ASSIGN(SaltingKeyCache);
+};
+
 // This class is used to keep track of a TPM session. Each instance of this
 // class is used to account for one instance of a TPM session. Currently
 // this class is used by AuthorizationSession instances to keep track of TPM
@@ -35,6 +60,11 @@ namespace trunks {
 class TRUNKS_EXPORT SessionManagerImpl : public SessionManager {
  public:
   explicit SessionManagerImpl(const TrunksFactory& factory);
+  // Same as above, but takes the salting key from |salting_key_cache| when it
+  // is cached there. |salting_key_cache| is not owned and must outlive this
+  // instance.
+  SessionManagerImpl(const TrunksFactory& factory,
+                     SaltingKeyCache* salting_key_cache);
   ~SessionManagerImpl() override;
 
   TPM_HANDLE GetSessionHandle() const override { return session_handle_; }
@@ -47,11 +77,34 @@ class TRUNKS_EXPORT SessionManagerImpl : public SessionManager {
                       HmacAuthorizationDelegate* delegate) override;
 
  private:
+  // Does the work of StartSession(). If |use_cached_salting_key| is true, a
+  // salting key from |salting_key_cache_| may be used, in which case
+  // |used_cached_salting_key| is set to true.
+  TPM_RC StartSessionInternal(TPM_SE session_type,
+                              TPMI_DH_ENTITY bind_entity,
+                              const std::string& bind_authorization_value,
+                              bool salted,
+                              bool enable_encryption,
+                              bool use_cached_salting_key,
+                              bool* used_cached_salting_key,
+                              HmacAuthorizationDelegate* delegate);
+
+  // Gets the RSA modulus of the SaltingKey into |modulus|, from
+  // |salting_key_cache_| if |use_cache| is true and it is cached there, or
+  // from the TPM otherwise. Sets |from_cache| to true if the cached modulus
+  // was used.
+  TPM_RC GetSaltingKeyModulus(bool use_cache,
+                              std::string* modulus,
+                              bool* from_cache);
+
   // This function is used to encrypt a plaintext salt |salt|, using RSA
   // public encrypt with the SaltingKey PKCS1_OAEP padding. It follows the
   // specification defined in TPM2.0 Part 1 Architecture, Appendix B.10.2.
+  // |modulus| is the RSA modulus of the SaltingKey.
   // The encrypted salt is stored in the out parameter |encrypted_salt|.
-  TPM_RC EncryptSalt(const std::string& salt, std::string* encrypted_salt);
+  TPM_RC EncryptSalt(const std::string& salt,
+                     const std::string& modulus,
+                     std::string* encrypted_salt);
 
   // This factory is only set in the constructor and is used to instantiate
   // The TPM class to forward commands to the TPM chip.
@@ -63,6 +116,10 @@ class TRUNKS_EXPORT SessionManagerImpl : public SessionManager {
   // destroyed.
   TPM_HANDLE session_handle_;
 
+  // Shared cache of the salting key. May be null, in which case the salting
+  // key is read from the TPM for every salted session.
+  SaltingKeyCache* salting_key_cache_;
+
   friend class SessionManagerTest;
   DISALLOW_COPY_AND_ASSIGN(SessionManagerImpl);
 };
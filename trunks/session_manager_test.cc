@@ -16,6 +16,7 @@
 
 #include "trunks/session_manager_impl.h"
 
+#include <string>
 #include <vector>
 
 #include <base/logging.h>
@@ -165,4 +166,49 @@ TEST_F(SessionManagerTest, StartSessionBadNonce) {
                                 &delegate_));
 }
 
+TEST_F(SessionManagerTest, StartSessionCachesSaltingKey) {
+  SaltingKeyCache salting_key_cache;
+  SessionManagerImpl session_manager(factory_, &salting_key_cache);
+  TPM2B_PUBLIC public_data;
+  public_data.public_area.type = TPM_ALG_RSA;
+  public_data.public_area.unique.rsa = GetValidRSAPublicKey();
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(kSaltingKey, _, _, _, _, nullptr))
+      .WillOnce(DoAll(SetArgPointee<2>(public_data), Return(TPM_RC_SUCCESS)));
+  TPM2B_NONCE nonce;
+  nonce.size = 20;
+  EXPECT_CALL(mock_tpm_,
+              StartAuthSessionSyncShort(_, TPM_RH_NULL, _, _, _, _, _, _, _, _))
+      .Times(2)
+      .WillRepeatedly(DoAll(SetArgPointee<8>(nonce), Return(TPM_RC_SUCCESS)));
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            session_manager.StartSession(TPM_SE_TRIAL, TPM_RH_NULL, "",
+                                         true, false, &delegate_));
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            session_manager.StartSession(TPM_SE_TRIAL, TPM_RH_NULL, "",
+                                         true, false, &delegate_));
+}
+
+TEST_F(SessionManagerTest, StartSessionRereadsStaleSaltingKey) {
+  SaltingKeyCache salting_key_cache;
+  salting_key_cache.Set(std::string(256, 'C'));
+  SessionManagerImpl session_manager(factory_, &salting_key_cache);
+  TPM2B_PUBLIC public_data;
+  public_data.public_area.type = TPM_ALG_RSA;
+  public_data.public_area.unique.rsa = GetValidRSAPublicKey();
+  EXPECT_CALL(mock_tpm_, ReadPublicSync(kSaltingKey, _, _, _, _, nullptr))
+      .WillOnce(DoAll(SetArgPointee<2>(public_data), Return(TPM_RC_SUCCESS)));
+  TPM2B_NONCE nonce;
+  nonce.size = 20;
+  EXPECT_CALL(mock_tpm_,
+              StartAuthSessionSyncShort(_, TPM_RH_NULL, _, _, _, _, _, _, _, _))
+      .WillOnce(Return(TPM_RC_VALUE))
+      .WillOnce(DoAll(SetArgPointee<8>(nonce), Return(TPM_RC_SUCCESS)));
+  EXPECT_EQ(TPM_RC_SUCCESS,
+            session_manager.StartSession(TPM_SE_TRIAL, TPM_RH_NULL, "",
+                                         true, false, &delegate_));
+  std::string cached_modulus;
+  EXPECT_TRUE(salting_key_cache.Get(&cached_modulus));
+  EXPECT_NE(std::string(256, 'C'), cached_modulus);
+}
+
 }  // namespace trunks
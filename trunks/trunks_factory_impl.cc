@@ -180,7 +180,7 @@ TrunksFactoryImpl::GetPasswordAuthorization(const std::string& password) const {
 }
 
 std::unique_ptr<SessionManager> TrunksFactoryImpl::GetSessionManager() const {
-  return std::make_unique<SessionManagerImpl>(*this);
+  return std::make_unique<SessionManagerImpl>(*this, &salting_key_cache_);
 }
 
 std::unique_ptr<HmacSession> TrunksFactoryImpl::GetHmacSession() const {
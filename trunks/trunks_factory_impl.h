@@ -26,6 +26,7 @@
 #include <base/time/time.h>
 
 #include "trunks/command_transceiver.h"
+#include "trunks/session_manager_impl.h"
 #include "trunks/trunks_export.h"
 
 namespace trunks {
@@ -79,6 +80,8 @@ class TRUNKS_EXPORT TrunksFactoryImpl : public TrunksFactory {
   std::unique_ptr<CommandTransceiver> default_transceiver_;
   std::unique_ptr<PostProcessingTransceiver> transceiver_;
   std::unique_ptr<Tpm> tpm_;
+  // Shared by all the session managers created by this factory.
+  mutable SaltingKeyCache salting_key_cache_;
   bool initialized_ = false;
 
   DISALLOW_COPY_AND_ASSIGN(TrunksFactoryImpl);
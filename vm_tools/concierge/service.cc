@@ -21,6 +21,7 @@
 #include <linux/vm_sockets.h>  // Needs to come after sys/socket.h
 
 #include <map>
+#include <set>
 #include <utility>
 #include <vector>
 
@@ -28,6 +29,7 @@
 #include <base/bind.h>
 #include <base/bind_helpers.h>
 #include <base/callback.h>
+#include <base/cancelable_callback.h>
 #include <base/files/file_enumerator.h>
 #include <base/files/file_path.h>
 #include <base/files/file_util.h>
@@ -39,6 +41,7 @@
 #include <base/strings/string_number_conversions.h>
 #include <base/strings/stringprintf.h>
 #include <base/synchronization/waitable_event.h>
+#include <base/task_runner_util.h>
 #include <base/threading/thread_task_runner_handle.h>
 #include <base/time/time.h>
 #include <base/version.h>
@@ -81,6 +84,10 @@ constexpr int kMaxExtraDisks = 10;
 // large compressed files), it could take 10 seconds to boot.
 constexpr base::TimeDelta kVmStartupTimeout = base::TimeDelta::FromSeconds(30);
 
+// How often progress is reported while a disk image is being exported.
+constexpr base::TimeDelta kDiskExportProgressInterval =
+    base::TimeDelta::FromSeconds(1);
+
 // crosvm directory name.
 constexpr char kCrosvmDir[] = "crosvm";
 
@@ -133,6 +140,98 @@ void HandleSynchronousDBusMethodCall(
   response_sender.Run(std::move(response));
 }
 
+// Serializes |response| into the response for every caller in |callers| and
+// sends it.
+void SendStartVmResponses(
+    std::vector<std::pair<std::unique_ptr<dbus::Response>,
+                          dbus::ExportedObject::ResponseSender>>* callers,
+    const StartVmResponse& response) {
+  for (auto& caller : *callers) {
+    dbus::MessageWriter writer(caller.first.get());
+    writer.AppendProtoAsArrayOfBytes(response);
+    caller.second.Run(std::move(caller.first));
+  }
+  callers->clear();
+}
+
+// Converts the disk image open at |disk_fd| to qcow2 and writes it to
+// |storage_fd|.  Runs on the disk export thread.
+int ConvertDiskImageToQcow2(base::ScopedFD disk_fd, base::ScopedFD storage_fd) {
+  return convert_to_qcow2(disk_fd.get(), storage_fd.get());
+}
+
+// Replies to an ExportDiskImage request once the conversion has finished
+// with |convert_res|.
+void SendExportDiskImageResponse(
+    std::unique_ptr<dbus::Response> dbus_response,
+    dbus::ExportedObject::ResponseSender response_sender,
+    int convert_res) {
+  ExportDiskImageResponse response;
+  if (convert_res < 0) {
+    response.set_status(DISK_STATUS_FAILED);
+    response.set_failure_reason("convert_to_qcow2 failed");
+  } else {
+    response.set_status(DISK_STATUS_CREATED);
+  }
+
+  dbus::MessageWriter writer(dbus_response.get());
+  writer.AppendProtoAsArrayOfBytes(response);
+  response_sender.Run(std::move(dbus_response));
+}
+
+// Finishes setting up a VM after maitre'd has reported that it is ready:
+// configures the network and performs the mounts requested in |request|.
+// Runs on the VM setup thread since every step is a blocking RPC to the VM.
+bool SetUpVm(VirtualMachine* vm,
+             const std::vector<string>& nameservers,
+             const std::vector<string>& search_domains,
+             const StartVmRequest& request,
+             uint32_t seneschal_server_port,
+             string* failure_reason) {
+  if (!vm->ConfigureNetwork(nameservers, search_domains)) {
+    LOG(ERROR) << "Failed to configure VM network";
+
+    *failure_reason = "Failed to configure VM network";
+    return false;
+  }
+
+  // Do all the mounts.  Assume that the rootfs filesystem was assigned
+  // /dev/vda and that every subsequent image was assigned a letter in
+  // alphabetical order starting from 'b'.
+  unsigned char disk_letter = 'b';
+  unsigned char offset = 0;
+  for (const auto& disk : request.disks()) {
+    string src = base::StringPrintf("/dev/vd%c", disk_letter + offset);
+    ++offset;
+
+    if (!disk.do_mount())
+      continue;
+
+    uint64_t flags = disk.flags();
+    if (!disk.writable()) {
+      flags |= MS_RDONLY;
+    }
+    if (!vm->Mount(std::move(src), disk.mount_point(), disk.fstype(), flags,
+                   disk.data())) {
+      LOG(ERROR) << "Failed to mount " << disk.path() << " -> "
+                 << disk.mount_point();
+
+      *failure_reason = "Failed to mount extra disk";
+      return false;
+    }
+  }
+
+  // Mount the 9p server.
+  if (!vm->Mount9P(seneschal_server_port, "/mnt/shared")) {
+    LOG(ERROR) << "Failed to mount " << request.shared_directory();
+
+    *failure_reason = "Failed to mount shared directory";
+    return false;
+  }
+
+  return true;
+}
+
 // Posted to a grpc thread to startup a listener service. Puts a copy of
 // the pointer to the grpc server in |server_copy| and then signals |event|.
 // It will listen on the address specified in |listener_address|.
@@ -313,8 +412,61 @@ bool GetDiskPathFromName(
   return true;
 }
 
+// Starts lxd in |vm| with |lxd_subnet| as the subnet for its bridge.  Runs on
+// the VM setup thread since it blocks until lxd is up.
+bool StartTerminaInVm(VirtualMachine* vm,
+                      const string& lxd_subnet,
+                      string* failure_reason) {
+  string error;
+  if (!vm->StartTermina(lxd_subnet, &error)) {
+    failure_reason->assign(error);
+    return false;
+  }
+  return true;
+}
+
 }  // namespace
 
+struct Service::PendingVmStart {
+  // Responses to send once the start completes.  A StartVm request for a VM
+  // that is still starting is added here instead of launching a second one.
+  std::vector<std::pair<std::unique_ptr<dbus::Response>,
+                        dbus::ExportedObject::ResponseSender>>
+      callers;
+
+  StartVmRequest request;
+  std::unique_ptr<VirtualMachine> vm;
+  uint32_t seneschal_server_port = 0;
+  uint32_t seneschal_server_handle = 0;
+
+  // Fires if the VM does not report that it is ready in time.
+  base::CancelableClosure timeout;
+
+  // Whether the post-boot setup or the lxd startup is running on
+  // |setup_thread|.  The entry must not be destroyed while it is.
+  bool setting_up = false;
+  // Set if the VM should be torn down once the setup has finished.
+  bool cancelled = false;
+  // Whether cicerone has been told that the VM started.
+  bool cicerone_notified = false;
+  // Written by the setup thread when the setup fails.
+  string failure_reason;
+
+  // DNS configuration the setup was started with.
+  std::vector<string> nameservers;
+  std::vector<string> search_domains;
+
+  // Timestamps of the startup phases, for logging.
+  base::TimeTicks start_time;
+  base::TimeTicks launch_time;
+  base::TimeTicks ready_time;
+  base::TimeTicks setup_time;
+
+  // Thread on which the blocking setup RPCs to this VM are made.  Declared
+  // last so that it is stopped before the members it uses are destroyed.
+  std::unique_ptr<base::Thread> setup_thread;
+};
+
 std::unique_ptr<Service> Service::Create(base::Closure quit_closure) {
   auto service = base::WrapUnique(new Service(std::move(quit_closure)));
 
@@ -386,13 +538,11 @@ bool Service::Init() {
   using ServiceMethod =
       std::unique_ptr<dbus::Response> (Service::*)(dbus::MethodCall*);
   const std::map<const char*, ServiceMethod> kServiceMethods = {
-      {kStartVmMethod, &Service::StartVm},
       {kStopVmMethod, &Service::StopVm},
       {kStopAllVmsMethod, &Service::StopAllVms},
       {kGetVmInfoMethod, &Service::GetVmInfo},
       {kCreateDiskImageMethod, &Service::CreateDiskImage},
       {kDestroyDiskImageMethod, &Service::DestroyDiskImage},
-      {kExportDiskImageMethod, &Service::ExportDiskImage},
       {kListVmDisksMethod, &Service::ListVmDisks},
       {kGetContainerSshKeysMethod, &Service::GetContainerSshKeys},
       {kSyncVmTimesMethod, &Service::SyncVmTimes},
@@ -409,6 +559,30 @@ bool Service::Init() {
     }
   }
 
+  // StartVm and ExportDiskImage reply asynchronously once the VM has finished
+  // booting or the image has been converted.
+  using AsyncServiceMethod = void (Service::*)(
+      dbus::MethodCall*, dbus::ExportedObject::ResponseSender);
+  const std::map<const char*, AsyncServiceMethod> kAsyncServiceMethods = {
+      {kStartVmMethod, &Service::StartVm},
+      {kExportDiskImageMethod, &Service::ExportDiskImage},
+  };
+
+  for (const auto& iter : kAsyncServiceMethods) {
+    bool ret = exported_object_->ExportMethodAndBlock(
+        kVmConciergeInterface, iter.first,
+        base::Bind(iter.second, base::Unretained(this)));
+    if (!ret) {
+      LOG(ERROR) << "Failed to export method " << iter.first;
+      return false;
+    }
+  }
+
+  if (!disk_export_thread_.Start()) {
+    LOG(ERROR) << "Failed to start disk export thread";
+    return false;
+  }
+
   if (!bus_->RequestOwnershipAndBlock(kVmConciergeServiceName,
                                       dbus::Bus::REQUIRE_PRIMARY)) {
     LOG(ERROR) << "Failed to take ownership of " << kVmConciergeServiceName;
@@ -532,6 +706,18 @@ void Service::HandleChildExit() {
       }
     }
 
+    // Fail the start of a VM that exits while booting instead of waiting for
+    // the startup timeout.  Once the setup RPCs are running they will fail on
+    // their own.
+    for (auto iter = pending_vm_starts_.begin();
+         iter != pending_vm_starts_.end(); ++iter) {
+      if (pid == iter->second->vm->pid() && !iter->second->setting_up) {
+        LOG(ERROR) << "VM exited while starting up";
+        FailPendingVmStart(iter, "VM exited while starting up");
+        break;
+      }
+    }
+
     if (WIFEXITED(status)) {
       LOG(INFO) << " Process " << pid << " exited with status "
                 << WEXITSTATUS(status);
@@ -555,10 +741,20 @@ void Service::HandleSigterm() {
   base::ThreadTaskRunnerHandle::Get()->PostTask(FROM_HERE, quit_closure_);
 }
 
-std::unique_ptr<dbus::Response> Service::StartVm(
-    dbus::MethodCall* method_call) {
+void Service::StartVm(dbus::MethodCall* method_call,
+                      dbus::ExportedObject::ResponseSender response_sender) {
+  std::unique_ptr<dbus::Response> dbus_response =
+      LaunchVm(method_call, &response_sender);
+  if (dbus_response)
+    response_sender.Run(std::move(dbus_response));
+}
+
+std::unique_ptr<dbus::Response> Service::LaunchVm(
+    dbus::MethodCall* method_call,
+    dbus::ExportedObject::ResponseSender* response_sender) {
   DCHECK(sequence_checker_.CalledOnValidSequence());
   LOG(INFO) << "Received StartVm request";
+  base::TimeTicks start_time = base::TimeTicks::Now();
 
   std::unique_ptr<dbus::Response> dbus_response(
       dbus::Response::FromMethodCall(method_call));
@@ -612,6 +808,15 @@ std::unique_ptr<dbus::Response> Service::StartVm(
     return dbus_response;
   }
 
+  // If the VM is still starting up, reply once it is done.
+  auto pending_iter = FindPendingVmStart(request.owner_id(), request.name());
+  if (pending_iter != pending_vm_starts_.end()) {
+    LOG(INFO) << "VM with requested name is already starting";
+    pending_iter->second->callers.emplace_back(std::move(dbus_response),
+                                               std::move(*response_sender));
+    return nullptr;
+  }
+
   if (request.disks_size() > kMaxExtraDisks) {
     LOG(ERROR) << "Rejecting request with " << request.disks_size()
                << " extra disks";
@@ -708,6 +913,21 @@ std::unique_ptr<dbus::Response> Service::StartVm(
     });
   }
 
+  // The VM would change the disk while the export is reading it.
+  std::vector<DiskImageId> writable_disks;
+  for (const auto& disk : disks) {
+    if (IsDiskImageExporting(disk.path)) {
+      LOG(ERROR) << "Disk " << disk.path.value() << " is being exported";
+
+      response.set_failure_reason("Disk image is being exported");
+      writer.AppendProtoAsArrayOfBytes(response);
+      return dbus_response;
+    }
+    struct stat disk_stat;
+    if (disk.writable && stat(disk.path.value().c_str(), &disk_stat) == 0)
+      writable_disks.emplace_back(disk_stat.st_dev, disk_stat.st_ino);
+  }
+
   // Create the runtime directory.
   base::FilePath runtime_dir;
   if (!base::CreateTemporaryDirInDir(base::FilePath(kRuntimeDir), "vm.",
@@ -752,14 +972,15 @@ std::unique_ptr<dbus::Response> Service::StartVm(
 
   uint32_t seneschal_server_handle = server_proxy->handle();
 
-  // Associate a WaitableEvent with this VM.  This needs to happen before
+  // Register the VM with the startup listener.  This needs to happen before
   // starting the VM to avoid a race where the VM reports that it's ready
   // before it gets added as a pending VM.
-  base::WaitableEvent event(base::WaitableEvent::ResetPolicy::AUTOMATIC,
-                            base::WaitableEvent::InitialState::NOT_SIGNALED);
-  startup_listener_.AddPendingVm(vsock_cid, &event);
+  startup_listener_.AddPendingVm(
+      vsock_cid, base::ThreadTaskRunnerHandle::Get(),
+      base::Bind(&Service::OnVmReady, weak_ptr_factory_.GetWeakPtr(),
+                 vsock_cid));
 
-  // Start the VM and build the response.
+  // Start the VM.
   auto vm = VirtualMachine::Create(
       std::move(kernel), std::move(rootfs), std::move(disks),
       std::move(mac_address), std::move(subnet), vsock_cid,
@@ -773,77 +994,149 @@ std::unique_ptr<dbus::Response> Service::StartVm(
     return dbus_response;
   }
 
-  // Wait for the VM to finish starting up and for maitre'd to signal that it's
-  // ready.
-  if (!event.TimedWait(kVmStartupTimeout)) {
-    LOG(ERROR) << "VM failed to start in " << kVmStartupTimeout.InSeconds()
-               << " seconds";
+  // Wait for maitre'd to signal that it's ready without blocking other
+  // requests.
+  auto pending = std::make_unique<PendingVmStart>();
+  pending->callers.emplace_back(std::move(dbus_response),
+                                std::move(*response_sender));
+  pending->request = std::move(request);
+  pending->vm = std::move(vm);
+  pending->seneschal_server_port = seneschal_server_port;
+  pending->seneschal_server_handle = seneschal_server_handle;
+  pending->start_time = start_time;
+  pending->launch_time = base::TimeTicks::Now();
+  pending->timeout.Reset(base::Bind(&Service::OnVmStartupTimeout,
+                                    weak_ptr_factory_.GetWeakPtr(), vsock_cid));
+  base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(
+      FROM_HERE, pending->timeout.callback(), kVmStartupTimeout);
+  pending_vm_starts_[vsock_cid] = std::move(pending);
+  vm_writable_disks_[vsock_cid] = std::move(writable_disks);
 
-    startup_listener_.RemovePendingVm(vsock_cid);
-    response.set_failure_reason("VM failed to start in time");
-    writer.AppendProtoAsArrayOfBytes(response);
-    return dbus_response;
-  }
+  return nullptr;
+}
 
-  // maitre'd is ready.  Finish setting up the VM.
-  if (!vm->ConfigureNetwork(nameservers_, search_domains_)) {
-    LOG(ERROR) << "Failed to configure VM network";
+void Service::OnVmReady(uint32_t vsock_cid) {
+  DCHECK(sequence_checker_.CalledOnValidSequence());
+  auto iter = pending_vm_starts_.find(vsock_cid);
+  if (iter == pending_vm_starts_.end())
+    return;
 
-    response.set_failure_reason("Failed to configure VM network");
-    writer.AppendProtoAsArrayOfBytes(response);
-    return dbus_response;
+  PendingVmStart* pending = iter->second.get();
+  pending->timeout.Cancel();
+  pending->ready_time = base::TimeTicks::Now();
+
+  // maitre'd is ready.  The setup RPCs block until the VM answers, so make
+  // them on a thread for this VM, which lets several VMs be set up at once.
+  // |pending| is not destroyed until the reply has run.
+  pending->setup_thread = std::make_unique<base::Thread>(
+      base::StringPrintf("VM Setup Thread %u", vsock_cid));
+  if (!pending->setup_thread->Start()) {
+    LOG(ERROR) << "Failed to start VM setup thread";
+    FailPendingVmStart(iter, "Failed to start VM setup thread");
+    return;
   }
+  pending->setting_up = true;
+  pending->nameservers = nameservers_;
+  pending->search_domains = search_domains_;
+  base::PostTaskAndReplyWithResult(
+      pending->setup_thread->task_runner().get(), FROM_HERE,
+      base::Bind(&SetUpVm, pending->vm.get(), pending->nameservers,
+                 pending->search_domains, pending->request,
+                 pending->seneschal_server_port,
+                 &pending->failure_reason),
+      base::Bind(&Service::OnVmSetUp, weak_ptr_factory_.GetWeakPtr(),
+                 vsock_cid));
+}
 
-  // Do all the mounts.  Assume that the rootfs filesystem was assigned
-  // /dev/vda and that every subsequent image was assigned a letter in
-  // alphabetical order starting from 'b'.
-  unsigned char disk_letter = 'b';
-  unsigned char offset = 0;
-  for (const auto& disk : request.disks()) {
-    string src = base::StringPrintf("/dev/vd%c", disk_letter + offset);
-    ++offset;
-
-    if (!disk.do_mount())
-      continue;
-
-    uint64_t flags = disk.flags();
-    if (!disk.writable()) {
-      flags |= MS_RDONLY;
-    }
-    if (!vm->Mount(std::move(src), disk.mount_point(), disk.fstype(), flags,
-                   disk.data())) {
-      LOG(ERROR) << "Failed to mount " << disk.path() << " -> "
-                 << disk.mount_point();
+void Service::OnVmSetUp(uint32_t vsock_cid, bool success) {
+  DCHECK(sequence_checker_.CalledOnValidSequence());
+  auto iter = pending_vm_starts_.find(vsock_cid);
+  DCHECK(iter != pending_vm_starts_.end());
 
-      response.set_failure_reason("Failed to mount extra disk");
-      writer.AppendProtoAsArrayOfBytes(response);
-      return dbus_response;
-    }
+  PendingVmStart* pending = iter->second.get();
+  pending->setting_up = false;
+  if (pending->cancelled) {
+    FailPendingVmStart(iter, "VM start was cancelled");
+    return;
   }
-
-  // Mount the 9p server.
-  if (!vm->Mount9P(seneschal_server_port, "/mnt/shared")) {
-    LOG(ERROR) << "Failed to mount " << request.shared_directory();
-
-    response.set_failure_reason("Failed to mount shared directory");
-    writer.AppendProtoAsArrayOfBytes(response);
-    return dbus_response;
+  if (!success) {
+    FailPendingVmStart(iter, pending->failure_reason);
+    return;
   }
+  pending->setup_time = base::TimeTicks::Now();
+
+  const StartVmRequest& request = pending->request;
+  VirtualMachine* vm = pending->vm.get();
 
   // Notify cicerone that we have started a VM.
   NotifyCiceroneOfVmStarted(request.owner_id(), request.name(),
                             vm->ContainerSubnet(), vm->ContainerNetmask(),
                             vm->IPv4Address(), vm->cid());
+  pending->cicerone_notified = true;
 
-  string failure_reason;
-  if (request.start_termina() && !StartTermina(vm.get(), &failure_reason)) {
-    response.set_failure_reason(std::move(failure_reason));
-    writer.AppendProtoAsArrayOfBytes(response);
-    return dbus_response;
+  if (!request.start_termina()) {
+    FinishVmStart(iter);
+    return;
+  }
+
+  string lxd_subnet;
+  if (!PrepareTermina(vm, &lxd_subnet, &pending->failure_reason)) {
+    FailPendingVmStart(iter, pending->failure_reason);
+    return;
+  }
+
+  // Starting lxd can take minutes, so wait for it on the setup thread too.
+  pending->setting_up = true;
+  base::PostTaskAndReplyWithResult(
+      pending->setup_thread->task_runner().get(), FROM_HERE,
+      base::Bind(&StartTerminaInVm, vm, lxd_subnet, &pending->failure_reason),
+      base::Bind(&Service::OnTerminaStarted, weak_ptr_factory_.GetWeakPtr(),
+                 vsock_cid));
+}
+
+void Service::OnTerminaStarted(uint32_t vsock_cid, bool success) {
+  DCHECK(sequence_checker_.CalledOnValidSequence());
+  auto iter = pending_vm_starts_.find(vsock_cid);
+  DCHECK(iter != pending_vm_starts_.end());
+
+  PendingVmStart* pending = iter->second.get();
+  pending->setting_up = false;
+  if (pending->cancelled) {
+    FailPendingVmStart(iter, "VM start was cancelled");
+    return;
+  }
+  if (!success) {
+    FailPendingVmStart(iter, pending->failure_reason);
+    return;
   }
 
-  LOG(INFO) << "Started VM with pid " << vm->pid();
+  FinishVmStart(iter);
+}
+
+void Service::FinishVmStart(PendingVmStartMap::iterator iter) {
+  PendingVmStart* pending = iter->second.get();
+  const StartVmRequest& request = pending->request;
+  VirtualMachine* vm = pending->vm.get();
+  uint32_t vsock_cid = iter->first;
+
+  // Pick up any DNS changes that happened while the VM was being set up.
+  if (pending->nameservers != nameservers_ ||
+      pending->search_domains != search_domains_) {
+    vm->SetResolvConfig(nameservers_, search_domains_);
+  }
+
+  base::TimeTicks now = base::TimeTicks::Now();
+  LOG(INFO) << "Started VM with pid " << vm->pid() << " in "
+            << (now - pending->start_time).InMilliseconds() << "ms (launch "
+            << (pending->launch_time - pending->start_time).InMilliseconds()
+            << "ms, boot "
+            << (pending->ready_time - pending->launch_time).InMilliseconds()
+            << "ms, setup "
+            << (pending->setup_time - pending->ready_time).InMilliseconds()
+            << "ms, finish " << (now - pending->setup_time).InMilliseconds()
+            << "ms)";
 
+  StartVmResponse response;
   VmInfo* vm_info = response.mutable_vm_info();
   response.set_success(true);
   response.set_status(request.start_termina() ? VM_STATUS_STARTING
@@ -851,11 +1144,58 @@ std::unique_ptr<dbus::Response> Service::StartVm(
   vm_info->set_ipv4_address(vm->IPv4Address());
   vm_info->set_pid(vm->pid());
   vm_info->set_cid(vsock_cid);
-  vm_info->set_seneschal_server_handle(seneschal_server_handle);
-  writer.AppendProtoAsArrayOfBytes(response);
+  vm_info->set_seneschal_server_handle(pending->seneschal_server_handle);
+  SendStartVmResponses(&pending->callers, response);
 
-  vms_[std::make_pair(request.owner_id(), request.name())] = std::move(vm);
-  return dbus_response;
+  vms_[std::make_pair(request.owner_id(), request.name())] =
+      std::move(pending->vm);
+  pending_vm_starts_.erase(iter);
+}
+
+void Service::OnVmStartupTimeout(uint32_t vsock_cid) {
+  DCHECK(sequence_checker_.CalledOnValidSequence());
+  auto iter = pending_vm_starts_.find(vsock_cid);
+  if (iter == pending_vm_starts_.end())
+    return;
+
+  LOG(ERROR) << "VM failed to start in " << kVmStartupTimeout.InSeconds()
+             << " seconds";
+  FailPendingVmStart(iter, "VM failed to start in time");
+}
+
+void Service::FailPendingVmStart(PendingVmStartMap::iterator iter,
+                                 const string& failure_reason) {
+  DCHECK(!iter->second->setting_up);
+  startup_listener_.RemovePendingVm(iter->first);
+
+  StartVmResponse response;
+  response.set_status(VM_STATUS_FAILURE);
+  response.set_failure_reason(failure_reason);
+  SendStartVmResponses(&iter->second->callers, response);
+
+  if (iter->second->cicerone_notified) {
+    NotifyCiceroneOfVmStopped(iter->second->request.owner_id(),
+                              iter->second->request.name());
+  }
+
+  // Destroying the VirtualMachine shuts the VM down.
+  pending_vm_starts_.erase(iter);
+}
+
+bool Service::CancelPendingVmStart(PendingVmStartMap::iterator iter) {
+  // The setup thread is still using the VM, so it can only be torn down once
+  // the setup has finished.  Shutting the VM down makes the RPC in flight
+  // fail instead of running to completion.
+  if (iter->second->setting_up) {
+    if (!iter->second->cancelled) {
+      iter->second->cancelled = true;
+      iter->second->vm->Shutdown();
+    }
+    return false;
+  }
+
+  FailPendingVmStart(iter, "VM start was cancelled");
+  return true;
 }
 
 std::unique_ptr<dbus::Response> Service::StopVm(dbus::MethodCall* method_call) {
@@ -881,7 +1221,14 @@ std::unique_ptr<dbus::Response> Service::StopVm(dbus::MethodCall* method_call) {
 
   auto iter = FindVm(request.owner_id(), request.name());
   if (iter == vms_.end()) {
-    LOG(ERROR) << "Requested VM does not exist";
+    // A VM that is still starting up is torn down as soon as its setup allows.
+    auto pending_iter = FindPendingVmStart(request.owner_id(), request.name());
+    if (pending_iter != pending_vm_starts_.end()) {
+      LOG(INFO) << "Cancelling start of requested VM";
+      CancelPendingVmStart(pending_iter);
+    } else {
+      LOG(ERROR) << "Requested VM does not exist";
+    }
     // This is not an error to Chrome
     response.set_success(true);
     writer.AppendProtoAsArrayOfBytes(response);
@@ -911,6 +1258,13 @@ std::unique_ptr<dbus::Response> Service::StopAllVms(
   DCHECK(sequence_checker_.CalledOnValidSequence());
   LOG(INFO) << "Received StopAllVms request";
 
+  // Abandon VMs that are still starting up.  Those with setup RPCs in flight
+  // are shut down now and destroyed once the RPCs return.
+  for (auto iter = pending_vm_starts_.begin();
+       iter != pending_vm_starts_.end();) {
+    CancelPendingVmStart(iter++);
+  }
+
   // Spawn a thread for each VM to shut it down.
   for (auto& iter : vms_) {
     // Notify cicerone that we have stopped a VM.
@@ -1005,7 +1359,9 @@ SyncVmTimesResponse Service::SyncVmTimesInternal() {
   return response;
 }
 
-bool Service::StartTermina(VirtualMachine* vm, string* failure_reason) {
+bool Service::PrepareTermina(VirtualMachine* vm,
+                             string* lxd_subnet,
+                             string* failure_reason) {
   DCHECK(sequence_checker_.CalledOnValidSequence());
   LOG(INFO) << "Starting lxd";
 
@@ -1060,15 +1416,7 @@ bool Service::StartTermina(VirtualMachine* vm, string* failure_reason) {
   IPv4AddressToString(container_subnet_addr, &dst_addr);
   size_t prefix = vm->ContainerPrefix();
 
-  std::string container_subnet_cidr =
-      base::StringPrintf("%s/%zu", dst_addr.c_str(), prefix);
-
-  string error;
-  if (!vm->StartTermina(std::move(container_subnet_cidr), &error)) {
-    failure_reason->assign(error);
-    return false;
-  }
-
+  *lxd_subnet = base::StringPrintf("%s/%zu", dst_addr.c_str(), prefix);
   return true;
 }
 
@@ -1077,6 +1425,9 @@ std::unique_ptr<dbus::Response> Service::CreateDiskImage(
   DCHECK(sequence_checker_.CalledOnValidSequence());
   LOG(INFO) << "Received CreateDiskImage request";
 
+  // The watchers may not have seen the change by the next ListVmDisks.
+  InvalidateDiskImageDirs();
+
   std::unique_ptr<dbus::Response> dbus_response(
       dbus::Response::FromMethodCall(method_call));
 
@@ -1204,6 +1555,9 @@ std::unique_ptr<dbus::Response> Service::DestroyDiskImage(
   DCHECK(sequence_checker_.CalledOnValidSequence());
   LOG(INFO) << "Received DestroyDiskImage request";
 
+  // The watchers may not have seen the change by the next ListVmDisks.
+  InvalidateDiskImageDirs();
+
   std::unique_ptr<dbus::Response> dbus_response(
       dbus::Response::FromMethodCall(method_call));
 
@@ -1240,6 +1594,22 @@ std::unique_ptr<dbus::Response> Service::DestroyDiskImage(
     vms_.erase(iter);
   }
 
+  // crosvm may still be booting from the disk, so it can only be deleted once
+  // the VM start has been torn down.
+  auto pending_iter =
+      FindPendingVmStart(request.cryptohome_id(), request.disk_path());
+  if (pending_iter != pending_vm_starts_.end()) {
+    LOG(INFO) << "Cancelling start of VM";
+    if (!CancelPendingVmStart(pending_iter)) {
+      LOG(ERROR) << "VM is still being set up";
+
+      response.set_status(DISK_STATUS_FAILED);
+      response.set_failure_reason("VM is still starting up");
+      writer.AppendProtoAsArrayOfBytes(response);
+      return dbus_response;
+    }
+  }
+
   base::FilePath disk_path;
   if (!GetDiskPathFromName(request.disk_path(), request.cryptohome_id(),
                            request.storage_location(),
@@ -1252,6 +1622,16 @@ std::unique_ptr<dbus::Response> Service::DestroyDiskImage(
     return dbus_response;
   }
 
+  if (IsDiskImageExporting(disk_path)) {
+    LOG(ERROR) << "Disk image is being exported";
+
+    response.set_status(DISK_STATUS_FAILED);
+    response.set_failure_reason("Disk image is being exported");
+    writer.AppendProtoAsArrayOfBytes(response);
+
+    return dbus_response;
+  }
+
   if (!EraseGuestSshKeys(request.cryptohome_id(), request.disk_path())) {
     // Don't return a failure here, just log an error because this is only a
     // side effect and not what the real request is about.
@@ -1280,8 +1660,18 @@ std::unique_ptr<dbus::Response> Service::DestroyDiskImage(
   return dbus_response;
 }
 
-std::unique_ptr<dbus::Response> Service::ExportDiskImage(
-    dbus::MethodCall* method_call) {
+void Service::ExportDiskImage(
+    dbus::MethodCall* method_call,
+    dbus::ExportedObject::ResponseSender response_sender) {
+  std::unique_ptr<dbus::Response> dbus_response =
+      StartDiskImageExport(method_call, &response_sender);
+  if (dbus_response)
+    response_sender.Run(std::move(dbus_response));
+}
+
+std::unique_ptr<dbus::Response> Service::StartDiskImageExport(
+    dbus::MethodCall* method_call,
+    dbus::ExportedObject::ResponseSender* response_sender) {
   DCHECK(sequence_checker_.CalledOnValidSequence());
   LOG(INFO) << "Received ExportDiskImage request";
 
@@ -1319,6 +1709,16 @@ std::unique_ptr<dbus::Response> Service::ExportDiskImage(
     return dbus_response;
   }
 
+  // A running VM would change the disk while it is being converted.
+  if (FindVm(request.cryptohome_id(), request.disk_path()) != vms_.end() ||
+      FindPendingVmStart(request.cryptohome_id(), request.disk_path()) !=
+          pending_vm_starts_.end()) {
+    LOG(ERROR) << "VM is running, not exporting its disk";
+    response.set_failure_reason("VM is running");
+    writer.AppendProtoAsArrayOfBytes(response);
+    return dbus_response;
+  }
+
   base::ScopedFD disk_fd(HANDLE_EINTR(
       open(disk_path.value().c_str(), O_RDWR | O_NOFOLLOW | O_CLOEXEC)));
   if (!disk_fd.is_valid()) {
@@ -1328,6 +1728,21 @@ std::unique_ptr<dbus::Response> Service::ExportDiskImage(
     return dbus_response;
   }
 
+  struct stat disk_stat;
+  if (fstat(disk_fd.get(), &disk_stat) != 0) {
+    PLOG(ERROR) << "Failed to stat VM disk for export";
+    response.set_failure_reason("Failed to stat VM disk for export");
+    writer.AppendProtoAsArrayOfBytes(response);
+    return dbus_response;
+  }
+  DiskImageId disk_id(disk_stat.st_dev, disk_stat.st_ino);
+  if (exporting_disks_.count(disk_id) != 0) {
+    LOG(ERROR) << "VM disk is already being exported";
+    response.set_failure_reason("VM disk is already being exported");
+    writer.AppendProtoAsArrayOfBytes(response);
+    return dbus_response;
+  }
+
   // Get the FD to fill with disk image data.
   base::ScopedFD storage_fd;
   if (!reader.PopFileDescriptor(&storage_fd)) {
@@ -1337,16 +1752,77 @@ std::unique_ptr<dbus::Response> Service::ExportDiskImage(
     return dbus_response;
   }
 
-  int convert_res = convert_to_qcow2(disk_fd.get(), storage_fd.get());
-  if (convert_res < 0) {
-    response.set_failure_reason("convert_to_qcow2 failed");
-    writer.AppendProtoAsArrayOfBytes(response);
-    return dbus_response;
+  // Report the progress of the export from the size of the file it writes.
+  auto disk_export = std::make_unique<DiskImageExport>();
+  disk_export->cryptohome_id = request.cryptohome_id();
+  disk_export->disk_path = request.disk_path();
+  disk_export->storage_fd.reset(HANDLE_EINTR(dup(storage_fd.get())));
+  disk_export->disk_size = disk_stat.st_blocks * 512;
+  if (disk_export->storage_fd.is_valid()) {
+    disk_export->progress_timer.Start(
+        FROM_HERE, kDiskExportProgressInterval,
+        base::Bind(&Service::SendDiskImageExportProgress,
+                   base::Unretained(this), disk_id));
+  } else {
+    PLOG(WARNING) << "Failed to duplicate export fd, not reporting progress";
+  }
+
+  // Converting a multi-gigabyte image takes a long time, so do it on
+  // |disk_export_thread_| and reply when it is done.
+  exporting_disks_[disk_id] = std::move(disk_export);
+  base::PostTaskAndReplyWithResult(
+      disk_export_thread_.task_runner().get(), FROM_HERE,
+      base::Bind(&ConvertDiskImageToQcow2, base::Passed(&disk_fd),
+                 base::Passed(&storage_fd)),
+      base::Bind(&Service::OnDiskImageExported, weak_ptr_factory_.GetWeakPtr(),
+                 disk_id, base::Passed(&dbus_response), *response_sender));
+  return nullptr;
+}
+
+void Service::OnDiskImageExported(
+    DiskImageId disk_id,
+    std::unique_ptr<dbus::Response> dbus_response,
+    dbus::ExportedObject::ResponseSender response_sender,
+    int convert_res) {
+  DCHECK(sequence_checker_.CalledOnValidSequence());
+  exporting_disks_.erase(disk_id);
+  SendExportDiskImageResponse(std::move(dbus_response),
+                              std::move(response_sender), convert_res);
+}
+
+void Service::SendDiskImageExportProgress(DiskImageId disk_id) {
+  DCHECK(sequence_checker_.CalledOnValidSequence());
+  auto iter = exporting_disks_.find(disk_id);
+  if (iter == exporting_disks_.end())
+    return;
+  const DiskImageExport& disk_export = *iter->second;
+
+  ExportDiskImageProgressSignal proto;
+  proto.set_cryptohome_id(disk_export.cryptohome_id);
+  proto.set_disk_path(disk_export.disk_path);
+  proto.set_disk_size(disk_export.disk_size);
+  struct stat storage_stat;
+  if (fstat(disk_export.storage_fd.get(), &storage_stat) == 0 &&
+      S_ISREG(storage_stat.st_mode)) {
+    proto.set_bytes_written(storage_stat.st_size);
   }
 
-  response.set_status(DISK_STATUS_CREATED);
-  writer.AppendProtoAsArrayOfBytes(response);
-  return dbus_response;
+  dbus::Signal signal(kVmConciergeInterface, kExportDiskImageProgressSignal);
+  dbus::MessageWriter(&signal).AppendProtoAsArrayOfBytes(proto);
+  exported_object_->SendSignal(&signal);
+}
+
+bool Service::IsDiskImageExporting(const base::FilePath& path) const {
+  if (exporting_disks_.empty())
+    return false;
+
+  // stat() follows /proc/self/fd links, so this also covers disks passed as
+  // file descriptors.
+  struct stat disk_stat;
+  if (stat(path.value().c_str(), &disk_stat) != 0)
+    return false;
+  return exporting_disks_.count(
+             DiskImageId(disk_stat.st_dev, disk_stat.st_ino)) != 0;
 }
 
 std::unique_ptr<dbus::Response> Service::ListVmDisks(
@@ -1387,8 +1863,52 @@ std::unique_ptr<dbus::Response> Service::ListVmDisks(
     return dbus_response;
   }
 
+  // Returns disk images in the given storage area.  A running VM grows its
+  // disks without closing them, which the directory watcher does not see, so
+  // only the sizes of the disks that VMs can write to are looked up again.
+  const std::set<DiskImageId> in_use = GetWritableDiskImagesInUse();
   uint64_t total_size = 0;
-  // Returns disk images in the given storage area.
+  for (const auto& image : GetDiskImages(image_dir)) {
+    response.add_images(image.name);
+    uint64_t size = image.size;
+    struct stat st;
+    if (in_use.count(image.id) != 0 &&
+        stat(image.path.value().c_str(), &st) == 0) {
+      size = st.st_blocks * 512;
+    }
+    total_size += size;
+  }
+  response.set_total_size(total_size);
+
+  writer.AppendProtoAsArrayOfBytes(response);
+  return dbus_response;
+}
+
+const Service::DiskImageList& Service::GetDiskImages(
+    const base::FilePath& image_dir) {
+  std::unique_ptr<DiskImageDir>& dir = disk_image_dirs_[image_dir];
+  if (!dir)
+    dir = std::make_unique<DiskImageDir>();
+  if (dir->valid)
+    return dir->images;
+
+  // Start watching before enumerating so that no change is missed.
+  if (dir->watcher_failed) {
+    dir->watcher.reset();
+    dir->watcher_failed = false;
+  }
+  if (!dir->watcher) {
+    dir->watcher = std::make_unique<base::FilePathWatcher>();
+    if (!dir->watcher->Watch(
+            image_dir, false /* recursive */,
+            base::Bind(&Service::OnDiskImageDirChanged,
+                       weak_ptr_factory_.GetWeakPtr()))) {
+      LOG(WARNING) << "Failed to watch " << image_dir.value();
+      dir->watcher.reset();
+    }
+  }
+
+  dir->images.clear();
   for (const auto& pattern : kDiskImagePatterns) {
     base::FileEnumerator dir_enum(image_dir, false, base::FileEnumerator::FILES,
                                   pattern);
@@ -1405,18 +1925,57 @@ std::unique_ptr<dbus::Response> Service::ListVmDisks(
                                  &image_name)) {
         continue;
       }
-      std::string* name = response.add_images();
-      *name = std::move(image_name);
-      struct stat st;
-      if (stat(path.value().c_str(), &st) == 0) {
-        total_size += st.st_blocks * 512;
-      }
+      // The enumerator has already stat()ed the file.
+      const struct stat& st = dir_enum.GetInfo().stat();
+      dir->images.push_back(DiskImage{
+          .name = std::move(image_name),
+          .path = std::move(path),
+          .id = DiskImageId(st.st_dev, st.st_ino),
+          .size = static_cast<uint64_t>(st.st_blocks) * 512,
+      });
     }
   }
-  response.set_total_size(total_size);
 
-  writer.AppendProtoAsArrayOfBytes(response);
-  return dbus_response;
+  // Without a watcher there is no way to tell when the listing goes stale.
+  dir->valid = dir->watcher != nullptr;
+  return dir->images;
+}
+
+std::set<Service::DiskImageId> Service::GetWritableDiskImagesInUse() {
+  std::set<uint32_t> live_cids;
+  for (const auto& pair : vms_)
+    live_cids.insert(pair.second->cid());
+  for (const auto& pair : pending_vm_starts_)
+    live_cids.insert(pair.first);
+
+  std::set<DiskImageId> in_use;
+  for (auto iter = vm_writable_disks_.begin();
+       iter != vm_writable_disks_.end();) {
+    if (live_cids.count(iter->first) == 0) {
+      iter = vm_writable_disks_.erase(iter);
+      continue;
+    }
+    in_use.insert(iter->second.begin(), iter->second.end());
+    ++iter;
+  }
+  return in_use;
+}
+
+void Service::InvalidateDiskImageDirs() {
+  for (auto& pair : disk_image_dirs_)
+    pair.second->valid = false;
+}
+
+void Service::OnDiskImageDirChanged(const base::FilePath& path, bool error) {
+  DCHECK(sequence_checker_.CalledOnValidSequence());
+  auto iter = disk_image_dirs_.find(path);
+  if (iter == disk_image_dirs_.end())
+    return;
+
+  iter->second->valid = false;
+  // The watcher can't be destroyed from within its own callback.
+  if (error)
+    iter->second->watcher_failed = true;
 }
 
 std::unique_ptr<dbus::Response> Service::GetContainerSshKeys(
@@ -1557,16 +2116,26 @@ void Service::OnTremplinStartedSignal(dbus::Signal* signal) {
     return;
   }
 
+  VirtualMachine* vm = nullptr;
   auto iter = FindVm(tremplin_started_signal.owner_id(),
                      tremplin_started_signal.vm_name());
-  if (iter == vms_.end()) {
+  if (iter != vms_.end()) {
+    vm = iter->second.get();
+  } else {
+    // Tremplin may report in before the lxd startup RPC has returned.
+    auto pending_iter = FindPendingVmStart(tremplin_started_signal.owner_id(),
+                                           tremplin_started_signal.vm_name());
+    if (pending_iter != pending_vm_starts_.end())
+      vm = pending_iter->second->vm.get();
+  }
+  if (!vm) {
     LOG(ERROR) << "Received signal from an unknown vm.";
     return;
   }
   LOG(INFO) << "Received TremplinStartedSignal for owner: "
             << tremplin_started_signal.owner_id()
             << ", vm: " << tremplin_started_signal.vm_name();
-  iter->second->SetTremplinStarted();
+  vm->SetTremplinStarted();
 }
 
 void Service::OnSignalConnected(const std::string& interface_name,
@@ -1609,5 +2178,21 @@ Service::VmMap::iterator Service::FindVm(std::string owner_id,
   return it;
 }
 
+Service::PendingVmStartMap::iterator Service::FindPendingVmStart(
+    const std::string& owner_id, const std::string& vm_name) {
+  auto fallback = pending_vm_starts_.end();
+  for (auto it = pending_vm_starts_.begin(); it != pending_vm_starts_.end();
+       ++it) {
+    const StartVmRequest& request = it->second->request;
+    if (request.name() != vm_name)
+      continue;
+    if (request.owner_id() == owner_id)
+      return it;
+    if (request.owner_id().empty())
+      fallback = it;
+  }
+  return fallback;
+}
+
 }  // namespace concierge
 }  // namespace vm_tools
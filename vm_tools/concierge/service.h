@@ -6,14 +6,18 @@
 #define VM_TOOLS_CONCIERGE_SERVICE_H_
 
 #include <stdint.h>
+#include <sys/types.h>
 
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <base/callback.h>
+#include <base/files/file_path.h>
+#include <base/files/file_path_watcher.h>
 #include <base/files/scoped_file.h>
 #include <base/macros.h>
 #include <base/memory/ref_counted.h>
@@ -22,6 +26,7 @@
 #include <base/sequence_checker.h>
 #include <base/synchronization/lock.h>
 #include <base/threading/thread.h>
+#include <base/timer/timer.h>
 #include <dbus/bus.h>
 #include <dbus/exported_object.h>
 #include <dbus/message.h>
@@ -67,14 +72,44 @@ class Service final : public base::MessageLoopForIO::Watcher {
   void HandleSigterm();
 
   // Handles a request to start a VM.  |method_call| must have a StartVmRequest
-  // protobuf serialized as an array of bytes.
-  std::unique_ptr<dbus::Response> StartVm(dbus::MethodCall* method_call);
+  // protobuf serialized as an array of bytes.  The response is sent through
+  // |response_sender| once the VM has finished starting up, so other requests
+  // can be handled while it boots.
+  void StartVm(dbus::MethodCall* method_call,
+               dbus::ExportedObject::ResponseSender response_sender);
+
+  // Validates a StartVm request and launches the VM.  Returns the response to
+  // send right away if the request failed or the VM is already running.
+  // Otherwise takes ownership of |response_sender| and returns nullptr; the
+  // response is then sent when the VM start completes.
+  std::unique_ptr<dbus::Response> LaunchVm(
+      dbus::MethodCall* method_call,
+      dbus::ExportedObject::ResponseSender* response_sender);
+
+  // Called when the VM with vsock context id |vsock_cid| reports that it is
+  // ready.  Starts the post-boot setup of the VM on a setup thread of its own,
+  // so that the setup of one VM does not wait for that of another.
+  void OnVmReady(uint32_t vsock_cid);
+
+  // Called once the post-boot setup for |vsock_cid| has finished.  Starts lxd
+  // on the setup thread of the VM if requested, otherwise finishes starting
+  // the VM.
+  void OnVmSetUp(uint32_t vsock_cid, bool success);
+
+  // Called once lxd has been started in the VM for |vsock_cid|.
+  void OnTerminaStarted(uint32_t vsock_cid, bool success);
+
+  // Called if the VM with vsock context id |vsock_cid| does not report that
+  // it is ready in time.
+  void OnVmStartupTimeout(uint32_t vsock_cid);
 
   // Handles a request to stop a VM.  |method_call| must have a StopVmRequest
   // protobuf serialized as an array of bytes.
   std::unique_ptr<dbus::Response> StopVm(dbus::MethodCall* method_call);
 
-  // Handles a request to stop all running VMs.
+  // Handles a request to stop all running VMs.  VMs whose setup RPCs are
+  // still in flight are shut down, but are only destroyed once those RPCs
+  // return, which may be after the reply has been sent.
   std::unique_ptr<dbus::Response> StopAllVms(dbus::MethodCall* method_call);
 
   // Handles a request to get VM info.
@@ -94,13 +129,64 @@ class Service final : public base::MessageLoopForIO::Watcher {
   std::unique_ptr<dbus::Response> DestroyDiskImage(
       dbus::MethodCall* method_call);
 
-  // Handles a request to export a disk image.
-  std::unique_ptr<dbus::Response> ExportDiskImage(
-      dbus::MethodCall* method_call);
+  // Handles a request to export a disk image.  The image is converted on
+  // |disk_export_thread_| and the response is sent through |response_sender|
+  // once that has finished.  ExportDiskImageProgress signals are sent in the
+  // meantime.
+  void ExportDiskImage(dbus::MethodCall* method_call,
+                       dbus::ExportedObject::ResponseSender response_sender);
+
+  // Validates an ExportDiskImage request and starts the export.  Returns the
+  // response to send right away if the request failed.  Otherwise takes
+  // ownership of |response_sender| and returns nullptr.
+  std::unique_ptr<dbus::Response> StartDiskImageExport(
+      dbus::MethodCall* method_call,
+      dbus::ExportedObject::ResponseSender* response_sender);
+
+  // Identifies a disk image file by device and inode number, so that it is
+  // recognized whether it was passed by path or by file descriptor.
+  using DiskImageId = std::pair<dev_t, ino_t>;
+
+  // Called on the main thread once the export of |disk_id| has finished with
+  // |convert_res|.  Replies to the ExportDiskImage caller.
+  void OnDiskImageExported(DiskImageId disk_id,
+                           std::unique_ptr<dbus::Response> dbus_response,
+                           dbus::ExportedObject::ResponseSender response_sender,
+                           int convert_res);
+
+  // Sends an ExportDiskImageProgress signal for the export of |disk_id|.
+  void SendDiskImageExportProgress(DiskImageId disk_id);
+
+  // Returns true if the disk image at |path| is currently being exported.
+  bool IsDiskImageExporting(const base::FilePath& path) const;
 
   // Handles a request to list existing disk images.
   std::unique_ptr<dbus::Response> ListVmDisks(dbus::MethodCall* method_call);
 
+  // A disk image found in a directory by ListVmDisks.
+  struct DiskImage {
+    // Decoded name of the image.
+    std::string name;
+    base::FilePath path;
+    DiskImageId id;
+    // Allocated size of the image when the listing was built.
+    uint64_t size;
+  };
+  using DiskImageList = std::vector<DiskImage>;
+
+  // Returns the disk images in |image_dir|.  The listing is cached and only
+  // rebuilt after the directory has changed.
+  const DiskImageList& GetDiskImages(const base::FilePath& image_dir);
+
+  // Returns the disk images that running or starting VMs can write to.
+  std::set<DiskImageId> GetWritableDiskImagesInUse();
+
+  // Forces GetDiskImages to rebuild every listing on its next call.
+  void InvalidateDiskImageDirs();
+
+  // Called by the FilePathWatcher of a directory listed by GetDiskImages.
+  void OnDiskImageDirChanged(const base::FilePath& path, bool error);
+
   // Handles a request to get the SSH keys for a container.
   std::unique_ptr<dbus::Response> GetContainerSshKeys(
       dbus::MethodCall* method_call);
@@ -109,8 +195,12 @@ class Service final : public base::MessageLoopForIO::Watcher {
   void OnResolvConfigChanged(std::vector<std::string> nameservers,
                              std::vector<std::string> search_domains);
 
-  // Helper for starting termina VMs, e.g. starting lxd.
-  bool StartTermina(VirtualMachine* vm, std::string* failure_reason);
+  // Helper for starting termina VMs.  Allocates the container subnet for lxd
+  // and routes it through |vm|.  The subnet to start lxd with is stored in
+  // |lxd_subnet|.
+  bool PrepareTermina(VirtualMachine* vm,
+                      std::string* lxd_subnet,
+                      std::string* failure_reason);
 
   // Helpers for notifying cicerone of VM started/stopped events, generating
   // container tokens and querying if a container is running.
@@ -138,6 +228,29 @@ class Service final : public base::MessageLoopForIO::Watcher {
   using VmMap = std::map<std::pair<std::string, std::string>,
                          std::unique_ptr<VirtualMachine>>;
 
+  // State of a VM that has been launched but has not finished starting up.
+  struct PendingVmStart;
+  using PendingVmStartMap = std::map<uint32_t, std::unique_ptr<PendingVmStart>>;
+
+  // Replies to the StartVm callers of the pending VM start at |iter| with
+  // |failure_reason| and destroys the VM.
+  void FailPendingVmStart(PendingVmStartMap::iterator iter,
+                          const std::string& failure_reason);
+
+  // Fails the pending VM start at |iter| if nothing is running on its setup
+  // thread and returns true.  Otherwise shuts the VM down so that the setup
+  // RPCs fail quickly, marks it to be torn down once they return and returns
+  // false.
+  bool CancelPendingVmStart(PendingVmStartMap::iterator iter);
+
+  // Replies to the StartVm callers of the pending VM start at |iter| and makes
+  // the VM active.
+  void FinishVmStart(PendingVmStartMap::iterator iter);
+
+  // Like FindVm, but for VMs that are still starting up.
+  PendingVmStartMap::iterator FindPendingVmStart(const std::string& owner_id,
+                                                 const std::string& vm_name);
+
   // Returns an iterator to vm with key (|owner_id|, |vm_name|). If no such
   // element exists, tries the former with |owner_id| equal to empty string.
   VmMap::iterator FindVm(std::string owner_id, std::string vm_name);
@@ -168,6 +281,44 @@ class Service final : public base::MessageLoopForIO::Watcher {
   // Active VMs keyed by (owner_id, vm_name).
   VmMap vms_;
 
+  // VMs that are still starting up, keyed by vsock context id.
+  PendingVmStartMap pending_vm_starts_;
+
+  // Thread on which disk images are converted for export.
+  // convert_to_qcow2 cannot be interrupted, so stopping the thread on
+  // shutdown waits for a running export to finish.
+  base::Thread disk_export_thread_{"Disk Export Thread"};
+
+  // State of a disk image export, kept on the main thread.
+  struct DiskImageExport {
+    std::string cryptohome_id;
+    std::string disk_path;
+    // Duplicate of the FD the image is written to, for reporting progress.
+    base::ScopedFD storage_fd;
+    uint64_t disk_size = 0;
+    base::RepeatingTimer progress_timer;
+  };
+
+  // Disk images that are being exported.  They must not be used by a VM or
+  // deleted until the export has finished.
+  std::map<DiskImageId, std::unique_ptr<DiskImageExport>> exporting_disks_;
+
+  // Writable disks of the VMs that have been launched, keyed by vsock context
+  // id.  Entries of VMs that are gone are dropped by
+  // GetWritableDiskImagesInUse.
+  std::map<uint32_t, std::vector<DiskImageId>> vm_writable_disks_;
+
+  // Cached disk image listings for ListVmDisks, keyed by directory.
+  struct DiskImageDir {
+    // Whether |images| still matches the directory contents.
+    bool valid = false;
+    // Set if |watcher| reported an error and must be recreated.
+    bool watcher_failed = false;
+    DiskImageList images;
+    std::unique_ptr<base::FilePathWatcher> watcher;
+  };
+  std::map<base::FilePath, std::unique_ptr<DiskImageDir>> disk_image_dirs_;
+
   // The shill D-Bus client.
   std::unique_ptr<ShillClient> shill_client_;
 
@@ -7,6 +7,11 @@
 #include <inttypes.h>
 #include <string.h>
 
+#include <utility>
+
+#include <base/location.h>
+#include <base/logging.h>
+
 namespace vm_tools {
 namespace concierge {
 
@@ -27,17 +32,20 @@ grpc::Status StartupListenerImpl::VmReady(grpc::ServerContext* ctx,
     return grpc::Status(grpc::FAILED_PRECONDITION, "VM is not known");
   }
 
-  iter->second->Signal();
+  iter->second.task_runner->PostTask(FROM_HERE, iter->second.ready_callback);
   pending_vms_.erase(iter);
 
   return grpc::Status::OK;
 }
 
-void StartupListenerImpl::AddPendingVm(uint32_t cid,
-                                       base::WaitableEvent* event) {
+void StartupListenerImpl::AddPendingVm(
+    uint32_t cid,
+    scoped_refptr<base::TaskRunner> task_runner,
+    base::Closure ready_callback) {
   base::AutoLock lock(vm_lock_);
 
-  pending_vms_[cid] = event;
+  pending_vms_[cid] = PendingVm{std::move(task_runner),
+                                std::move(ready_callback)};
 }
 
 void StartupListenerImpl::RemovePendingVm(uint32_t cid) {
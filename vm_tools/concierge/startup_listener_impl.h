@@ -9,9 +9,11 @@
 
 #include <map>
 
+#include <base/callback.h>
 #include <base/macros.h>
+#include <base/memory/ref_counted.h>
 #include <base/synchronization/lock.h>
-#include <base/synchronization/waitable_event.h>
+#include <base/task_runner.h>
 #include <grpc++/grpc++.h>
 
 #include "vm_host.grpc.pb.h"  // NOLINT(build/include)
@@ -19,8 +21,8 @@
 namespace vm_tools {
 namespace concierge {
 
-// Listens for VMs to announce that they are ready before signaling the
-// WaitableEvent associated with that VM.
+// Listens for VMs to announce that they are ready before posting the
+// callback associated with that VM.
 class StartupListenerImpl final : public vm_tools::StartupListener::Service {
  public:
   StartupListenerImpl() = default;
@@ -32,15 +34,23 @@ class StartupListenerImpl final : public vm_tools::StartupListener::Service {
                        vm_tools::EmptyMessage* response) override;
 
   // Add the VM with the vsock context id |cid| to the set of VMs that have
-  // been started but have not checked in as ready yet.
-  void AddPendingVm(uint32_t cid, base::WaitableEvent* event);
+  // been started but have not checked in as ready yet.  |ready_callback| is
+  // posted to |task_runner| once the VM checks in.
+  void AddPendingVm(uint32_t cid,
+                    scoped_refptr<base::TaskRunner> task_runner,
+                    base::Closure ready_callback);
 
-  // Remove the WaitableEvent associated with |cid|.
+  // Remove the callback associated with |cid|.
   void RemovePendingVm(uint32_t cid);
 
  private:
+  struct PendingVm {
+    scoped_refptr<base::TaskRunner> task_runner;
+    base::Closure ready_callback;
+  };
+
   // VMs that have been started but have not checked in as being ready yet.
-  std::map<uint32_t, base::WaitableEvent*> pending_vms_;
+  std::map<uint32_t, PendingVm> pending_vms_;
 
   // Lock to protect |pending_vms_|.
   base::Lock vm_lock_;
@@ -0,0 +1,63 @@
+// Copyright 2018 The Chromium OS Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "vm_tools/garcon/desktop_file_cache.h"
+
+#include <sys/stat.h>
+
+#include <base/logging.h>
+
+namespace vm_tools {
+namespace garcon {
+
+const DesktopFileCache::Entry& DesktopFileCache::Get(
+    const base::FilePath& path, const base::FileEnumerator::FileInfo& info) {
+  seen_.insert(path);
+  const struct stat& st = info.stat();
+  // Package managers write a new file and rename it over the old one, keeping
+  // the modification time from the package, so the inode and change time are
+  // checked too.
+  const base::Time last_changed = base::Time::FromTimeSpec(st.st_ctim);
+  CachedFile& cached = files_[path];
+  if (cached.inode == st.st_ino &&
+      cached.last_modified == info.GetLastModifiedTime() &&
+      cached.last_changed == last_changed && cached.size == info.GetSize()) {
+    return cached.entry;
+  }
+
+  cached.inode = st.st_ino;
+  cached.last_modified = info.GetLastModifiedTime();
+  cached.last_changed = last_changed;
+  cached.size = info.GetSize();
+  cached.entry.desktop_file = DesktopFile::ParseDesktopFile(path);
+  cached.entry.package_id_known = false;
+  cached.entry.package_id.clear();
+  if (!cached.entry.desktop_file) {
+    LOG(WARNING) << "Failed parsing the .desktop file: " << path.value();
+  }
+  return cached.entry;
+}
+
+void DesktopFileCache::SetPackageId(const base::FilePath& path,
+                                    const std::string& package_id) {
+  auto it = files_.find(path);
+  if (it == files_.end())
+    return;
+  it->second.entry.package_id_known = true;
+  it->second.entry.package_id = package_id;
+}
+
+void DesktopFileCache::RemoveUnseen() {
+  for (auto it = files_.begin(); it != files_.end();) {
+    if (seen_.count(it->first) == 0) {
+      it = files_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  seen_.clear();
+}
+
+}  // namespace garcon
+}  // namespace vm_tools
@@ -0,0 +1,76 @@
+// Copyright 2018 The Chromium OS Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef VM_TOOLS_GARCON_DESKTOP_FILE_CACHE_H_
+#define VM_TOOLS_GARCON_DESKTOP_FILE_CACHE_H_
+
+#include <sys/types.h>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+#include <base/files/file_enumerator.h>
+#include <base/files/file_path.h>
+#include <base/macros.h>
+#include <base/time/time.h>
+
+#include "vm_tools/garcon/desktop_file.h"
+
+namespace vm_tools {
+namespace garcon {
+
+// Keeps parsed .desktop files and the packages that own them across
+// application list updates. An entry is reused as long as its file has not
+// been modified or replaced, which is what a package install, upgrade or
+// removal does to the files it touches.
+class DesktopFileCache {
+ public:
+  struct Entry {
+    // Null if the file failed to parse.
+    std::unique_ptr<DesktopFile> desktop_file;
+
+    // Whether |package_id| holds the result of a PackageKit query for this
+    // file. An empty |package_id| then means no package owns the file.
+    bool package_id_known = false;
+    std::string package_id;
+  };
+
+  DesktopFileCache() = default;
+  ~DesktopFileCache() = default;
+
+  // Returns the entry for the .desktop file at |path|, which a FileEnumerator
+  // reported with |info|. The file is parsed again, and its package_id
+  // forgotten, if it changed since it was cached.
+  const Entry& Get(const base::FilePath& path,
+                   const base::FileEnumerator::FileInfo& info);
+
+  // Records |package_id| as the owner of the file at |path| if it is still
+  // cached.
+  void SetPackageId(const base::FilePath& path, const std::string& package_id);
+
+  // Drops the entries for files that were not passed to Get() since the last
+  // call.
+  void RemoveUnseen();
+
+ private:
+  struct CachedFile {
+    Entry entry;
+    ino_t inode = 0;
+    base::Time last_modified;
+    base::Time last_changed;
+    int64_t size = 0;
+  };
+
+  std::map<base::FilePath, CachedFile> files_;
+  std::set<base::FilePath> seen_;
+
+  DISALLOW_COPY_AND_ASSIGN(DesktopFileCache);
+};
+
+}  // namespace garcon
+}  // namespace vm_tools
+
+#endif  // VM_TOOLS_GARCON_DESKTOP_FILE_CACHE_H_
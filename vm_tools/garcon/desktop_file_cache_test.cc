@@ -0,0 +1,125 @@
+// Copyright 2018 The Chromium OS Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include <base/files/file_enumerator.h>
+#include <base/files/file_path.h>
+#include <base/files/file_util.h>
+#include <base/files/scoped_temp_dir.h>
+#include <gtest/gtest.h>
+
+#include "vm_tools/garcon/desktop_file_cache.h"
+
+namespace vm_tools {
+namespace garcon {
+
+namespace {
+
+constexpr char kDesktopFileContents[] =
+    "[Desktop Entry]\n"
+    "Type=Application\n"
+    "Name=Test\n"
+    "Exec=test\n";
+constexpr char kPackageId[] = "test;1.0;amd64;main";
+
+class DesktopFileCacheTest : public ::testing::Test {
+ public:
+  DesktopFileCacheTest() {
+    CHECK(temp_dir_.CreateUniqueTempDir());
+    apps_dir_ = temp_dir_.GetPath().Append("applications");
+    CHECK(base::CreateDirectory(apps_dir_));
+  }
+  ~DesktopFileCacheTest() override = default;
+
+  base::FilePath WriteDesktopFile(const std::string& name,
+                                  const std::string& contents) {
+    base::FilePath path = apps_dir_.Append(name);
+    EXPECT_EQ(contents.size(),
+              base::WriteFile(path, contents.c_str(), contents.size()));
+    return path;
+  }
+
+  // Passes every file in |apps_dir_| to |cache_| like an application list
+  // update does, and returns the entry for |path|.
+  const DesktopFileCache::Entry* Scan(const base::FilePath& path) {
+    const DesktopFileCache::Entry* result = nullptr;
+    base::FileEnumerator file_enum(apps_dir_, false,
+                                   base::FileEnumerator::FILES);
+    for (base::FilePath enum_path = file_enum.Next(); !enum_path.empty();
+         enum_path = file_enum.Next()) {
+      const DesktopFileCache::Entry& entry =
+          cache_.Get(enum_path, file_enum.GetInfo());
+      if (enum_path == path)
+        result = &entry;
+    }
+    cache_.RemoveUnseen();
+    return result;
+  }
+
+ protected:
+  base::ScopedTempDir temp_dir_;
+  base::FilePath apps_dir_;
+  DesktopFileCache cache_;
+};
+
+}  // namespace
+
+TEST_F(DesktopFileCacheTest, UnchangedFileKeepsPackageId) {
+  base::FilePath path = WriteDesktopFile("test.desktop", kDesktopFileContents);
+  const DesktopFileCache::Entry* entry = Scan(path);
+  ASSERT_NE(nullptr, entry);
+  ASSERT_NE(nullptr, entry->desktop_file);
+  EXPECT_FALSE(entry->package_id_known);
+  cache_.SetPackageId(path, kPackageId);
+
+  // Another package being installed next to it does not make the file need
+  // another PackageKit query.
+  WriteDesktopFile("other.desktop", kDesktopFileContents);
+  entry = Scan(path);
+  ASSERT_NE(nullptr, entry);
+  EXPECT_TRUE(entry->package_id_known);
+  EXPECT_EQ(kPackageId, entry->package_id);
+}
+
+TEST_F(DesktopFileCacheTest, ReplacedFileForgetsPackageId) {
+  base::FilePath path = WriteDesktopFile("test.desktop", kDesktopFileContents);
+  base::Time mtime;
+  {
+    base::File::Info info;
+    ASSERT_TRUE(base::GetFileInfo(path, &info));
+    mtime = info.last_modified;
+  }
+  ASSERT_NE(nullptr, Scan(path));
+  cache_.SetPackageId(path, kPackageId);
+
+  // Replace the file the way a package upgrade does: same contents and
+  // modification time, but a new inode.
+  base::FilePath new_path =
+      WriteDesktopFile("test.desktop.new", kDesktopFileContents);
+  ASSERT_TRUE(base::TouchFile(new_path, mtime, mtime));
+  ASSERT_TRUE(base::ReplaceFile(new_path, path, nullptr));
+  const DesktopFileCache::Entry* entry = Scan(path);
+  ASSERT_NE(nullptr, entry);
+  EXPECT_FALSE(entry->package_id_known);
+  EXPECT_TRUE(entry->package_id.empty());
+}
+
+TEST_F(DesktopFileCacheTest, RemovedFileIsDropped) {
+  base::FilePath path = WriteDesktopFile("test.desktop", kDesktopFileContents);
+  ASSERT_NE(nullptr, Scan(path));
+  cache_.SetPackageId(path, kPackageId);
+
+  ASSERT_TRUE(base::DeleteFile(path, false));
+  EXPECT_EQ(nullptr, Scan(path));
+
+  // A file that reappears at the same path is queried again.
+  WriteDesktopFile("test.desktop", kDesktopFileContents);
+  const DesktopFileCache::Entry* entry = Scan(path);
+  ASSERT_NE(nullptr, entry);
+  EXPECT_FALSE(entry->package_id_known);
+}
+
+}  // namespace garcon
+}  // namespace vm_tools
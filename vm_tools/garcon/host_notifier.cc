@@ -404,13 +404,13 @@ void HostNotifier::SendAppListToHost() {
       if (enum_path.FinalExtension() != kDesktopFileExtension) {
         continue;
       }
-      // We have a .desktop file path, parse it and then add it to the
-      // protobuf if it parses successfully.
-      std::unique_ptr<DesktopFile> desktop_file =
-          DesktopFile::ParseDesktopFile(enum_path);
+      // We have a .desktop file path, parse it unless the cached copy is
+      // still current and then add it to the protobuf if it parses
+      // successfully.
+      const DesktopFileCache::Entry& cached =
+          desktop_file_cache_.Get(enum_path, file_enum.GetInfo());
+      const DesktopFile* desktop_file = cached.desktop_file.get();
       if (!desktop_file) {
-        LOG(WARNING) << "Failed parsing the .desktop file: "
-                     << enum_path.value();
         continue;
       }
       // If we have already seen this desktop file ID then don't analyze this
@@ -457,11 +457,16 @@ void HostNotifier::SendAppListToHost() {
       app->set_no_display(desktop_file->no_display());
       app->set_startup_wm_class(desktop_file->startup_wm_class());
       app->set_startup_notify(desktop_file->startup_notify());
+      app->set_package_id(cached.package_id);
 
       callback_state->desktop_files_for_application.push_back(enum_path);
+      callback_state->package_id_known.push_back(cached.package_id_known);
     }
   }
 
+  // Forget .desktop files that no longer exist.
+  desktop_file_cache_.RemoveUnseen();
+
   CHECK_EQ(callback_state->desktop_files_for_application.size(),
            callback_state->request.application_size());
 
@@ -472,7 +477,7 @@ void HostNotifier::SendAppListToHost() {
   //
   // Query each .desktop file in turn. The callback will record the info for
   // that file and also kick off the query for the next file until all files
-  // have been queried.
+  // have been queried. Files whose package_id is cached are skipped.
   callback_state->num_package_id_queries_completed = 0;
 
   // Clear this in case it was set, this all happens on the same thread.
@@ -491,11 +496,31 @@ void HostNotifier::SendAppListToHost() {
 
 void HostNotifier::RequestNextPackageIdOrCompleteUpdateApplicationList(
     std::unique_ptr<AppListBuilderState> state) {
+  while (state->num_package_id_queries_completed <
+             state->desktop_files_for_application.size() &&
+         state->package_id_known[state->num_package_id_queries_completed]) {
+    state->num_package_id_queries_completed++;
+  }
   if ((state->num_package_id_queries_completed >=
        state->desktop_files_for_application.size())) {
-    // We have finished all package_id queries. This data is ready to send to
-    // the host.
+    // We have finished all package_id queries. Remember the results; a file
+    // that a package transaction replaced in the meantime is queried again on
+    // the next update since the cache sees that it changed.
+    for (size_t i = 0; i < state->desktop_files_for_application.size(); ++i) {
+      if (state->package_id_known[i]) {
+        desktop_file_cache_.SetPackageId(
+            state->desktop_files_for_application[i],
+            state->request.application(i).package_id());
+      }
+    }
+
+    // This data is ready to send to the host.
     send_app_list_to_host_in_progress_ = false;
+    std::string serialized_request = state->request.SerializeAsString();
+    if (serialized_request == last_app_list_sent_) {
+      VLOG(3) << "Application list is unchanged, not sending it to the host";
+      return;
+    }
     vm_tools::EmptyMessage empty;
     grpc::ClientContext ctx;
     grpc::Status status =
@@ -504,7 +529,10 @@ void HostNotifier::RequestNextPackageIdOrCompleteUpdateApplicationList(
     if (!status.ok()) {
       LOG(WARNING) << "Failed to notify host of the application list: "
                    << status.error_message();
+      last_app_list_sent_.clear();
+      return;
     }
+    last_app_list_sent_ = std::move(serialized_request);
     return;
   }
   // else we still need to do more package_id queries
@@ -533,6 +561,10 @@ void HostNotifier::PackageIdCallback(
   } else if (!success) {
     LOG(ERROR) << "Failed to get Package Info: " << error;
   }
+  // Only remember definitive answers; failed queries are retried next time.
+  if (success) {
+    state->package_id_known[state->num_package_id_queries_completed] = true;
+  }
 
   state->num_package_id_queries_completed++;
   task_runner_->PostTask(
@@ -5,17 +5,22 @@
 #ifndef VM_TOOLS_GARCON_HOST_NOTIFIER_H_
 #define VM_TOOLS_GARCON_HOST_NOTIFIER_H_
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include <base/files/file_path.h>
 #include <base/files/file_path_watcher.h>
 #include <base/files/scoped_file.h>
 #include <base/macros.h>
 #include <base/message_loop/message_loop.h>
+#include <base/time/time.h>
 #include <grpc++/grpc++.h>
 
 #include "container_host.grpc.pb.h"  // NOLINT(build/include)
+#include "vm_tools/garcon/desktop_file.h"
+#include "vm_tools/garcon/desktop_file_cache.h"
 #include "vm_tools/garcon/package_kit_proxy.h"
 
 namespace vm_tools {
@@ -70,6 +75,11 @@ class HostNotifier : public base::MessageLoopForIO::Watcher,
     // |request.application| (same number, same order).
     std::vector<base::FilePath> desktop_files_for_application;
 
+    // Whether the package_id of each application is known, either from
+    // |desktop_file_cache_| or from a successful query. Same order as
+    // |desktop_files_for_application|.
+    std::vector<bool> package_id_known;
+
     // Number of .desktop files we have already queried for their package_id.
     // Thus, also the index of the next .desktop file we need to query for
     // its package_id.
@@ -138,6 +148,14 @@ class HostNotifier : public base::MessageLoopForIO::Watcher,
   // MIME types list.
   bool update_mime_types_posted_;
 
+  // Parsed .desktop files and their package_ids from the last application
+  // list update.
+  DesktopFileCache desktop_file_cache_;
+
+  // Serialized form of the last application list the host accepted, used to
+  // skip sending an identical list again.
+  std::string last_app_list_sent_;
+
   // Closure for stopping the MessageLoop.  Posted to the thread's TaskRunner
   // when this program receives a SIGTERM.
   base::Closure shutdown_closure_;
@@ -5,11 +5,19 @@
 #include "vm_tools/garcon/icon_finder.h"
 
 #include <algorithm>
+#include <iterator>
+#include <map>
 #include <memory>
+#include <set>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include <base/files/file_enumerator.h>
 #include <base/files/file_path.h>
+#include <base/bind.h>
 #include <base/files/file_util.h>
+#include <base/logging.h>
 #include <base/strings/stringprintf.h>
 #include <base/strings/string_split.h>
 #include "vm_tools/garcon/desktop_file.h"
@@ -44,23 +52,38 @@ std::vector<base::FilePath> GetPathsForIconIndexDirs() {
   return retval;
 }
 
-}  // namespace
+// Returns the directories to search for an icon with the |icon_size| and
+// |scale| preferences, most preferred first. The default pixmaps dir comes
+// last as a last resort.
+std::vector<base::FilePath> GetIconSearchDirs(int icon_size, int scale) {
+  std::vector<base::FilePath> retval;
+  for (const base::FilePath& icon_dir : GetPathsForIconIndexDirs()) {
+    std::vector<base::FilePath> paths =
+        GetPathsForIcons(icon_dir, icon_size, scale);
+    std::move(paths.begin(), paths.end(), std::back_inserter(retval));
+  }
+  retval.emplace_back(kDefaultPixmapsDir);
+  return retval;
+}
 
-std::vector<base::FilePath> GetPathsForIcons(const base::FilePath& icon_dir,
-                                             int icon_size,
-                                             int scale) {
-  std::unique_ptr<IconIndexFile> icon_index_file =
-      IconIndexFile::ParseIconIndexFile(icon_dir);
-  if (icon_index_file) {
-    return icon_index_file->GetPathsForSizeAndScale(icon_size, scale);
-  } else {
-    return {};
+// Returns the names of the png files directly under |dir|.
+std::set<std::string> ListIconFiles(const base::FilePath& dir) {
+  std::set<std::string> retval;
+  base::FileEnumerator file_enum(dir, false, base::FileEnumerator::FILES,
+                                 "*.png");
+  for (base::FilePath path = file_enum.Next(); !path.empty();
+       path = file_enum.Next()) {
+    retval.insert(path.BaseName().value());
   }
+  return retval;
 }
 
-base::FilePath LocateIconFile(const std::string& desktop_file_id,
-                              int icon_size,
-                              int scale) {
+// Looks up the icon named by the .desktop file for |desktop_file_id|. Returns
+// the icon path if the .desktop file names an absolute png path. Otherwise
+// returns an empty path and, if the .desktop file names an icon, sets
+// |icon_filename| to the file name to look for in the icon directories.
+base::FilePath GetDesktopFileIcon(const std::string& desktop_file_id,
+                                  std::string* icon_filename) {
   base::FilePath desktop_file_path =
       DesktopFile::FindFileForDesktopId(desktop_file_id);
   if (desktop_file_path.empty()) {
@@ -85,26 +108,124 @@ base::FilePath LocateIconFile(const std::string& desktop_file_id,
       return base::FilePath();
     }
   }
-  std::string icon_filename =
-      desktop_file_icon_filepath.AddExtension("png").value();
-  for (const base::FilePath& icon_dir : GetPathsForIconIndexDirs()) {
-    for (const base::FilePath& curr_path :
-         GetPathsForIcons(icon_dir, icon_size, scale)) {
-      base::FilePath test_path = curr_path.Append(icon_filename);
-      if (base::PathExists(test_path))
-        return test_path;
-    }
+  *icon_filename = desktop_file_icon_filepath.AddExtension("png").value();
+  return base::FilePath();
+}
+
+}  // namespace
+
+std::vector<base::FilePath> GetPathsForIcons(const base::FilePath& icon_dir,
+                                             int icon_size,
+                                             int scale) {
+  std::unique_ptr<IconIndexFile> icon_index_file =
+      IconIndexFile::ParseIconIndexFile(icon_dir);
+  if (icon_index_file) {
+    return icon_index_file->GetPathsForSizeAndScale(icon_size, scale);
+  } else {
+    return {};
   }
+}
 
-  // Also check the default pixmaps dir as a last resort.
-  base::FilePath test_path =
-      base::FilePath(kDefaultPixmapsDir).Append(icon_filename);
-  if (base::PathExists(test_path))
-    return test_path;
+base::FilePath LocateIconFile(const std::string& desktop_file_id,
+                              int icon_size,
+                              int scale) {
+  std::string icon_filename;
+  base::FilePath icon_path =
+      GetDesktopFileIcon(desktop_file_id, &icon_filename);
+  if (!icon_path.empty() || icon_filename.empty())
+    return icon_path;
+
+  for (const base::FilePath& curr_path : GetIconSearchDirs(icon_size, scale)) {
+    base::FilePath test_path = curr_path.Append(icon_filename);
+    if (base::PathExists(test_path))
+      return test_path;
+  }
 
   LOG(INFO) << "No icon file found for " << desktop_file_id;
   return base::FilePath();
 }
 
+IconIndex::IconIndex() : stale_(false), watching_(false) {}
+
+IconIndex::~IconIndex() = default;
+
+bool IconIndex::WatchIconDirs() {
+  std::vector<base::FilePath> watch_paths = GetPathsForIconIndexDirs();
+  watch_paths.emplace_back(kDefaultPixmapsDir);
+  for (const base::FilePath& path : watch_paths) {
+    std::unique_ptr<base::FilePathWatcher> watcher =
+        std::make_unique<base::FilePathWatcher>();
+    if (!watcher->Watch(
+            path, true,
+            base::Bind(&IconIndex::IconDirsChanged, base::Unretained(this)))) {
+      LOG(ERROR) << "Failed setting up filesystem path watcher for dir: "
+                 << path.value();
+      continue;
+    }
+    watchers_.emplace_back(std::move(watcher));
+  }
+  watching_ = !watchers_.empty();
+  return watching_;
+}
+
+void IconIndex::Invalidate() {
+  stale_ = true;
+}
+
+void IconIndex::IconDirsChanged(const base::FilePath& path, bool error) {
+  if (error)
+    LOG(ERROR) << "Error detected in icon directory watching";
+  // Even on error, an unnecessary re-read is cheaper than a stale icon.
+  Invalidate();
+}
+
+std::vector<base::FilePath> IconIndex::LocateIconFiles(
+    const std::vector<std::string>& desktop_file_ids,
+    int icon_size,
+    int scale) {
+  // A change that happens while the directories are being listed below marks
+  // the index stale again, so it is picked up by the next lookup. Without
+  // watchers, the next lookup always starts over.
+  if (stale_.exchange(!watching_)) {
+    search_dirs_.clear();
+    dir_contents_.clear();
+  }
+
+  std::vector<base::FilePath> retval;
+  retval.reserve(desktop_file_ids.size());
+
+  for (const std::string& desktop_file_id : desktop_file_ids) {
+    std::string icon_filename;
+    base::FilePath icon_path =
+        GetDesktopFileIcon(desktop_file_id, &icon_filename);
+    if (icon_path.empty() && !icon_filename.empty()) {
+      // Both are filled in lazily, so that icon directories are only read if
+      // an icon actually has to be looked up in them.
+      auto dirs_it = search_dirs_.find(std::make_pair(icon_size, scale));
+      if (dirs_it == search_dirs_.end()) {
+        dirs_it = search_dirs_
+                      .emplace(std::make_pair(icon_size, scale),
+                               GetIconSearchDirs(icon_size, scale))
+                      .first;
+      }
+      for (const base::FilePath& curr_path : dirs_it->second) {
+        auto it = dir_contents_.find(curr_path);
+        if (it == dir_contents_.end()) {
+          it = dir_contents_.emplace(curr_path, ListIconFiles(curr_path))
+                   .first;
+        }
+        if (it->second.count(icon_filename) > 0) {
+          icon_path = curr_path.Append(icon_filename);
+          break;
+        }
+      }
+      if (icon_path.empty())
+        LOG(INFO) << "No icon file found for " << desktop_file_id;
+    }
+    retval.push_back(std::move(icon_path));
+  }
+  return retval;
+}
+
 }  // namespace garcon
 }  // namespace vm_tools
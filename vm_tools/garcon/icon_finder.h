@@ -5,10 +5,17 @@
 #ifndef VM_TOOLS_GARCON_ICON_FINDER_H_
 #define VM_TOOLS_GARCON_ICON_FINDER_H_
 
+#include <atomic>
+#include <map>
+#include <memory>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <base/files/file_path.h>
+#include <base/files/file_path_watcher.h>
+#include <base/macros.h>
 
 namespace vm_tools {
 namespace garcon {
@@ -20,6 +27,60 @@ base::FilePath LocateIconFile(const std::string& desktop_file_id,
                               int icon_size,
                               int scale);
 
+// Remembers the icon search directories and the icons in them across
+// lookups, until something under the icon directories changes.
+//
+// Lookups are made on the gRPC server thread, which has no IO message loop,
+// while the watchers run on the main thread. The gRPC thread must not block on
+// the main thread (see main.cc), so the watchers only mark the index stale and
+// the next lookup drops it.
+class IconIndex {
+ public:
+  IconIndex();
+  ~IconIndex();
+
+  // Starts watching the icon directories for changes. Must be called on a
+  // thread with an IO message loop, which is also the thread that has to
+  // destroy this object. Until this succeeds, nothing is kept between
+  // lookups. Returns false if no directory could be watched.
+  bool WatchIconDirs();
+
+  // Same as calling LocateIconFile for each of |desktop_file_ids|, with the
+  // results in the same order and an empty path where no icon was found. The
+  // icon theme index files are parsed once per |icon_size| and |scale|, and
+  // each icon directory is listed once, until the index is invalidated.
+  std::vector<base::FilePath> LocateIconFiles(
+      const std::vector<std::string>& desktop_file_ids,
+      int icon_size,
+      int scale);
+
+  // Makes the next lookup read the icon directories again. May be called on
+  // any thread.
+  void Invalidate();
+
+ private:
+  // Callback for the watchers on the icon directories.
+  void IconDirsChanged(const base::FilePath& path, bool error);
+
+  // Set when |search_dirs_| and |dir_contents_| may be out of date.
+  std::atomic<bool> stale_;
+
+  // Set once changes to the icon directories are being watched.
+  std::atomic<bool> watching_;
+
+  // Directories to search for each icon size and scale, most preferred first.
+  // Only used by LocateIconFiles().
+  std::map<std::pair<int, int>, std::vector<base::FilePath>> search_dirs_;
+
+  // Names of the png files in each directory listed so far. Only used by
+  // LocateIconFiles().
+  std::map<base::FilePath, std::set<std::string>> dir_contents_;
+
+  std::vector<std::unique_ptr<base::FilePathWatcher>> watchers_;
+
+  DISALLOW_COPY_AND_ASSIGN(IconIndex);
+};
+
 // Returns a vector of directory paths under |icon_dir| that can be searched
 // under for an icon. The |icon_size| and |scale| parameters are preferences
 // rather than strict criteria. A directory that matches these criteria more
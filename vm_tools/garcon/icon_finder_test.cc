@@ -10,6 +10,7 @@
 #include <base/files/scoped_temp_dir.h>
 #include <base/files/file_path.h>
 #include <base/files/file_util.h>
+#include <base/message_loop/message_loop.h>
 #include <gtest/gtest.h>
 
 #include "vm_tools/garcon/icon_finder.cc"
@@ -139,5 +140,86 @@ TEST_F(IconFinderTest, HappyCase) {
   EXPECT_TRUE(LocateIconFile("gimp", 48, 1) == icon_file_path);
 }
 
+// This test verifies that icons for several desktop files are returned in
+// request order, with an empty path for the ones that have no icon.
+TEST_F(IconFinderTest, LocateMultipleIcons) {
+  std::unique_ptr<base::Environment> env = base::Environment::Create();
+  env->SetVar("XDG_DATA_DIRS", data_dir().value());
+  WriteDesktopFile("gimp.desktop",
+                   "[Desktop Entry]\n"
+                   "Type=Application\n"
+                   "Name=gimp\n"
+                   "Icon=gimp");
+  WriteDesktopFile("inkscape.desktop",
+                   "[Desktop Entry]\n"
+                   "Type=Application\n"
+                   "Name=inkscape\n"
+                   "Icon=inkscape");
+  WriteDesktopFile("noicon.desktop",
+                   "[Desktop Entry]\n"
+                   "Type=Application\n"
+                   "Name=noicon\n"
+                   "Icon=noicon");
+  WriteIndexThemeFile(
+      "[Icon Theme]\n"
+      "Name=Hicolor\n"
+      "Comment=Fallback icon theme\n"
+      "Hidden=true\n"
+      "Directories=48x48/apps\n"
+      "\n\n"
+      "[48x48/apps]\n"
+      "Size=48\n"
+      "Context=Applications\n"
+      "Type=Threshold\n\n");
+  base::FilePath gimp_path = icon_dir().Append("gimp.png");
+  base::WriteFile(gimp_path, "", 0);
+  base::FilePath inkscape_path = icon_dir().Append("inkscape.png");
+  base::WriteFile(inkscape_path, "", 0);
+  std::vector<base::FilePath> expected_paths = {
+      inkscape_path, base::FilePath(), gimp_path, base::FilePath()};
+  IconIndex icon_index;
+  EXPECT_TRUE(icon_index.LocateIconFiles({"inkscape", "noicon", "gimp",
+                                          "missing"},
+                                         48, 1) == expected_paths);
+}
+
+// This test verifies that a watched icon index keeps serving what it listed
+// before until it is invalidated.
+TEST_F(IconFinderTest, IndexKeptUntilInvalidated) {
+  base::MessageLoopForIO message_loop;
+  std::unique_ptr<base::Environment> env = base::Environment::Create();
+  env->SetVar("XDG_DATA_DIRS", data_dir().value());
+  WriteDesktopFile("gimp.desktop",
+                   "[Desktop Entry]\n"
+                   "Type=Application\n"
+                   "Name=gimp\n"
+                   "Icon=gimp");
+  WriteIndexThemeFile(
+      "[Icon Theme]\n"
+      "Name=Hicolor\n"
+      "Comment=Fallback icon theme\n"
+      "Hidden=true\n"
+      "Directories=48x48/apps\n"
+      "\n\n"
+      "[48x48/apps]\n"
+      "Size=48\n"
+      "Context=Applications\n"
+      "Type=Threshold\n\n");
+  IconIndex icon_index;
+  ASSERT_TRUE(icon_index.WatchIconDirs());
+  EXPECT_TRUE(icon_index.LocateIconFiles({"gimp"}, 48, 1) ==
+              std::vector<base::FilePath>{base::FilePath()});
+
+  // The message loop doesn't run, so the watchers can't invalidate the index.
+  base::FilePath icon_file_path = icon_dir().Append("gimp.png");
+  base::WriteFile(icon_file_path, "", 0);
+  EXPECT_TRUE(icon_index.LocateIconFiles({"gimp"}, 48, 1) ==
+              std::vector<base::FilePath>{base::FilePath()});
+
+  icon_index.Invalidate();
+  EXPECT_TRUE(icon_index.LocateIconFiles({"gimp"}, 48, 1) ==
+              std::vector<base::FilePath>{icon_file_path});
+}
+
 }  // namespace garcon
 }  // namespace vm_tools
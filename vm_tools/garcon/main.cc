@@ -40,6 +40,7 @@ const int kSyslogCritical = LOG_CRIT;
 
 #include "vm_tools/common/constants.h"
 #include "vm_tools/garcon/host_notifier.h"
+#include "vm_tools/garcon/icon_finder.h"
 #include "vm_tools/garcon/package_kit_proxy.h"
 #include "vm_tools/garcon/service_impl.h"
 
@@ -79,6 +80,7 @@ bool LogToSyslog(logging::LogSeverity severity,
 }
 
 void RunGarconService(vm_tools::garcon::PackageKitProxy* pk_proxy,
+                      vm_tools::garcon::IconIndex* icon_index,
                       base::WaitableEvent* event,
                       std::shared_ptr<grpc::Server>* server_copy,
                       int* vsock_listen_port) {
@@ -94,7 +96,7 @@ void RunGarconService(vm_tools::garcon::PackageKitProxy* pk_proxy,
       base::StringPrintf("vsock:%u:%u", VMADDR_CID_ANY, VMADDR_PORT_ANY),
       grpc::InsecureServerCredentials(), vsock_listen_port);
 
-  vm_tools::garcon::ServiceImpl garcon_service(pk_proxy);
+  vm_tools::garcon::ServiceImpl garcon_service(pk_proxy, icon_index);
   builder.RegisterService(&garcon_service);
 
   std::shared_ptr<grpc::Server> server(builder.BuildAndStart().release());
@@ -248,12 +250,17 @@ int main(int argc, char** argv) {
   }
   event.Reset();
 
+  // Used by the gRPC server to look up icons, and invalidated by watchers on
+  // the main thread.
+  vm_tools::garcon::IconIndex icon_index;
+
   // Launch the gRPC server on the gRPC thread.
   std::shared_ptr<grpc::Server> server_copy;
   int vsock_listen_port = 0;
   ret = grpc_thread.task_runner()->PostTask(
-      FROM_HERE, base::Bind(&RunGarconService, pk_proxy.get(), &event,
-                            &server_copy, &vsock_listen_port));
+      FROM_HERE,
+      base::Bind(&RunGarconService, pk_proxy.get(), &icon_index, &event,
+                 &server_copy, &vsock_listen_port));
   if (!ret) {
     LOG(ERROR) << "Failed to post server startup task to grpc thread";
     return -1;
@@ -278,6 +285,11 @@ int main(int argc, char** argv) {
     return -1;
   }
 
+  // This has to happen after HostNotifier::Init() has blocked SIGTERM, since
+  // the watchers spawn threads.
+  if (!icon_index.WatchIconDirs())
+    LOG(WARNING) << "Icons will be looked up without being cached";
+
   // Start the main run loop now for the HostNotifier.
   run_loop.Run();
 
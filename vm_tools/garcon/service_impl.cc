@@ -419,9 +419,11 @@ bool Spawn(std::vector<std::string> argv,
 
 }  // namespace
 
-ServiceImpl::ServiceImpl(PackageKitProxy* package_kit_proxy)
-    : package_kit_proxy_(package_kit_proxy) {
+ServiceImpl::ServiceImpl(PackageKitProxy* package_kit_proxy,
+                         IconIndex* icon_index)
+    : package_kit_proxy_(package_kit_proxy), icon_index_(icon_index) {
   CHECK(package_kit_proxy_);
+  CHECK(icon_index_);
 }
 
 grpc::Status ServiceImpl::LaunchApplication(
@@ -503,10 +505,14 @@ grpc::Status ServiceImpl::GetIcon(
     vm_tools::container::IconResponse* response) {
   LOG(INFO) << "Received request to get application icons in container";
 
-  for (const std::string& desktop_file_id : request->desktop_file_ids()) {
+  std::vector<std::string> desktop_file_ids(
+      request->desktop_file_ids().begin(), request->desktop_file_ids().end());
+  std::vector<base::FilePath> icon_filepaths = icon_index_->LocateIconFiles(
+      desktop_file_ids, request->icon_size(), request->scale());
+  for (size_t i = 0; i < desktop_file_ids.size(); ++i) {
+    const std::string& desktop_file_id = desktop_file_ids[i];
+    const base::FilePath& icon_filepath = icon_filepaths[i];
     std::string icon_data;
-    base::FilePath icon_filepath =
-        LocateIconFile(desktop_file_id, request->icon_size(), request->scale());
     if (icon_filepath.empty()) {
       continue;
     }
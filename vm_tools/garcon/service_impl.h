@@ -15,12 +15,13 @@
 namespace vm_tools {
 namespace garcon {
 
+class IconIndex;
 class PackageKitProxy;
 
 // Actually implements the garcon service.
 class ServiceImpl final : public vm_tools::container::Garcon::Service {
  public:
-  explicit ServiceImpl(PackageKitProxy* package_kit_proxy);
+  ServiceImpl(PackageKitProxy* package_kit_proxy, IconIndex* icon_index);
   ~ServiceImpl() override = default;
 
   // Garcon::Service overrides.
@@ -61,6 +62,7 @@ class ServiceImpl final : public vm_tools::container::Garcon::Service {
 
  private:
   PackageKitProxy* package_kit_proxy_;  // Not owned.
+  IconIndex* icon_index_;               // Not owned.
 
   DISALLOW_COPY_AND_ASSIGN(ServiceImpl);
 };
@@ -253,6 +253,32 @@ void DBusProtocolHandler::CompleteRequest(
       base::Bind(&IgnoreDBusError));
 }
 
+void DBusProtocolHandler::CompleteRequestWithFile(
+    const std::string& request_id,
+    int status_code,
+    const std::multimap<std::string, std::string>& headers,
+    base::File file) {
+  ProtocolHandlerProxyInterface* proxy =
+      GetRequestProtocolHandlerProxy(request_id);
+  if (!proxy)
+    return;
+
+  std::vector<std::tuple<std::string, std::string>> header_list;
+  header_list.reserve(headers.size());
+  for (const auto& pair : headers)
+    header_list.emplace_back(pair.first, pair.second);
+
+  int64_t offset = file.Seek(base::File::FROM_CURRENT, 0);
+  if (offset < 0)
+    offset = 0;
+  brillo::dbus_utils::FileDescriptor contents{
+      base::ScopedFD{file.TakePlatformFile()}};
+  proxy->CompleteRequestWithFileAsync(request_id, status_code, header_list,
+                                      contents, offset, -1,
+                                      base::Bind(&base::DoNothing),
+                                      base::Bind(&IgnoreDBusError));
+}
+
 void DBusProtocolHandler::GetFileData(
     const std::string& request_id,
     int file_id,
@@ -22,6 +22,7 @@
 #include <vector>
 
 #include <base/callback_forward.h>
+#include <base/files/file.h>
 #include <base/macros.h>
 #include <base/memory/weak_ptr.h>
 #include <brillo/errors/error.h>
@@ -120,6 +121,15 @@ class LIBWEBSERV_PRIVATE DBusProtocolHandler : public ProtocolHandler {
       const std::multimap<std::string, std::string>& headers,
       brillo::StreamPtr data_stream);
 
+  // Called by Response object to finish the request with the contents of a
+  // regular file. The file descriptor is passed to the web server, which
+  // sends the data directly, starting at the current file position.
+  void CompleteRequestWithFile(
+      const std::string& request_id,
+      int status_code,
+      const std::multimap<std::string, std::string>& headers,
+      base::File file);
+
   // Makes a call to the (remote) web server request handler over D-Bus to
   // obtain the file content of uploaded file (identified by |file_id|) during
   // request with |request_id|.
@@ -58,4 +58,17 @@ void DBusResponse::Reply(int status_code,
                             std::move(data_stream_));
 }
 
+void DBusResponse::ReplyWithFile(int status_code,
+                                 base::File file,
+                                 const std::string& mime_type) {
+  CHECK(file.IsValid());
+  status_code_ = status_code;
+  AddHeader(brillo::http::response_header::kContentType, mime_type);
+
+  CHECK(!reply_sent_) << "Response already sent";
+  reply_sent_ = true;
+  handler_->CompleteRequestWithFile(request_id_, status_code_, headers_,
+                                    std::move(file));
+}
+
 }  // namespace libwebserv
@@ -39,6 +39,9 @@ class DBusResponse final : public Response {
   void Reply(int status_code,
              brillo::StreamPtr data_stream,
              const std::string& mime_type) override;
+  void ReplyWithFile(int status_code,
+                     base::File file,
+                     const std::string& mime_type) override;
 
  private:
   friend class DBusProtocolHandler;
@@ -14,10 +14,13 @@
 
 #include <libwebserv/response.h>
 
+#include <utility>
+
 #include <base/json/json_writer.h>
 #include <base/values.h>
 #include <brillo/http/http_request.h>
 #include <brillo/mime_utils.h>
+#include <brillo/streams/file_stream.h>
 #include <brillo/streams/memory_stream.h>
 
 namespace libwebserv {
@@ -27,6 +30,19 @@ void Response::AddHeader(const std::string& header_name,
   AddHeaders({std::pair<std::string, std::string>{header_name, value}});
 }
 
+void Response::ReplyWithFile(int status_code,
+                             base::File file,
+                             const std::string& mime_type) {
+  brillo::StreamPtr stream = brillo::FileStream::FromFileDescriptor(
+      file.TakePlatformFile(), true, nullptr);
+  if (!stream) {
+    ReplyWithError(brillo::http::status_code::InternalServerError,
+                   "Failed to read the response file");
+    return;
+  }
+  Reply(status_code, std::move(stream), mime_type);
+}
+
 void Response::ReplyWithText(int status_code,
                              const std::string& text,
                              const std::string& mime_type) {
@@ -21,6 +21,7 @@
 #include <utility>
 #include <vector>
 
+#include <base/files/file.h>
 #include <base/macros.h>
 #include <brillo/streams/stream.h>
 #include <libwebserv/export.h>
@@ -52,6 +53,13 @@ class LIBWEBSERV_EXPORT Response {
                      brillo::StreamPtr data_stream,
                      const std::string& mime_type) = 0;
 
+  // Reply with the contents of the regular file |file|, from its current
+  // position to the end. Implementations may hand the file over to the web
+  // server so the data is sent without being copied through this process.
+  virtual void ReplyWithFile(int status_code,
+                             base::File file,
+                             const std::string& mime_type);
+
   // Reply with text body.
   virtual void ReplyWithText(int status_code,
                              const std::string& text,
@@ -14,6 +14,8 @@
 
 #include "webservd/dbus_protocol_handler.h"
 
+#include <unistd.h>
+
 #include <utility>
 
 #include <base/bind.h>
@@ -198,6 +200,37 @@ bool DBusProtocolHandler::CompleteRequest(
   return false;
 }
 
+bool DBusProtocolHandler::CompleteRequestWithFile(
+    brillo::ErrorPtr* error,
+    const std::string& in_request_id,
+    int32_t in_status_code,
+    const std::vector<std::tuple<std::string, std::string>>& in_headers,
+    const base::ScopedFD& in_contents,
+    int64_t in_offset,
+    int64_t in_data_size) {
+  auto request = GetRequest(in_request_id, error);
+  if (!request)
+    return false;
+
+  // |in_contents| is owned by the D-Bus message, so the request gets its own
+  // descriptor that outlives this call.
+  base::File file{dup(in_contents.get())};
+  if (!file.IsValid()) {
+    brillo::Error::AddTo(error, FROM_HERE, brillo::errors::dbus::kDomain,
+                         DBUS_ERROR_FAILED, "Invalid file descriptor");
+    return false;
+  }
+
+  if (request->CompleteWithFile(in_status_code, in_headers, std::move(file),
+                                in_offset, in_data_size)) {
+    return true;
+  }
+  brillo::Error::AddTo(error, FROM_HERE, brillo::errors::dbus::kDomain,
+                       DBUS_ERROR_FAILED,
+                       "Response already received or invalid file range");
+  return false;
+}
+
 Request* DBusProtocolHandler::GetRequest(const std::string& request_id,
                                          brillo::ErrorPtr* error) {
   Request* request = protocol_handler_->GetRequest(request_id);
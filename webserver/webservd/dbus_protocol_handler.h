@@ -85,6 +85,15 @@ class DBusProtocolHandler final
       int64_t in_data_size,
       brillo::dbus_utils::FileDescriptor* out_response_stream) override;
 
+  bool CompleteRequestWithFile(
+      brillo::ErrorPtr* error,
+      const std::string& in_request_id,
+      int32_t in_status_code,
+      const std::vector<std::tuple<std::string, std::string>>& in_headers,
+      const base::ScopedFD& in_contents,
+      int64_t in_offset,
+      int64_t in_data_size) override;
+
  private:
   using RequestHandlerProxy = org::chromium::WebServer::RequestHandlerProxy;
 
@@ -0,0 +1,252 @@
+// Copyright 2018 The Android Open Source Project
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "webservd/dbus_protocol_handler.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include <base/files/file_util.h>
+#include <base/files/scoped_file.h>
+#include <base/files/scoped_temp_dir.h>
+#include <base/message_loop/message_loop.h>
+#include <base/posix/eintr_wrapper.h>
+#include <base/run_loop.h>
+#include <base/strings/string_util.h>
+#include <base/threading/platform_thread.h>
+#include <brillo/dbus/exported_object_manager.h>
+#include <dbus/mock_bus.h>
+#include <gtest/gtest.h>
+
+#include "webservd/config.h"
+#include "webservd/log_manager.h"
+#include "webservd/protocol_handler.h"
+#include "webservd/request.h"
+#include "webservd/request_handler_interface.h"
+#include "webservd/server_interface.h"
+#include "webservd/temp_file_manager.h"
+
+namespace webservd {
+
+namespace {
+
+const char kRequest[] = "GET /file HTTP/1.0\r\n\r\n";
+const char kFileContents[] = "0123456789abcdef";
+// Number of times the message loop is run while waiting for the server.
+const int kMaxIterations = 500;
+
+struct NullLogger : public LogManager::LoggerInterface {
+  void Log(const base::Time& timestamp, const std::string& entry) override {}
+};
+
+class NullFileDeleter : public TempFileManager::FileDeleterInterface {
+ public:
+  bool DeleteFile(const base::FilePath& path) override { return true; }
+};
+
+class FakeServer : public ServerInterface {
+ public:
+  FakeServer() : temp_file_manager_{base::FilePath{}, &file_deleter_} {}
+
+  void ProtocolHandlerStarted(ProtocolHandler* handler) override {}
+  void ProtocolHandlerStopped(ProtocolHandler* handler) override {}
+  const Config& GetConfig() const override { return config_; }
+  TempFileManager* GetTempFileManager() override {
+    return &temp_file_manager_;
+  }
+
+ private:
+  Config config_;
+  NullFileDeleter file_deleter_;
+  TempFileManager temp_file_manager_;
+};
+
+// Remembers the ID of the last request it was asked to handle, and leaves the
+// request for the test to complete.
+class RecordingRequestHandler : public RequestHandlerInterface {
+ public:
+  explicit RecordingRequestHandler(std::string* request_id)
+      : request_id_{request_id} {}
+
+  void HandleRequest(Request* request, const std::string& src) override {
+    *request_id_ = request->GetID();
+  }
+
+ private:
+  std::string* request_id_;
+};
+
+}  // Anonymous namespace
+
+class DBusProtocolHandlerTest : public testing::Test {
+ public:
+  void SetUp() override {
+    LogManager::SetLogger(
+        std::unique_ptr<LogManager::LoggerInterface>(new NullLogger));
+
+    dbus::Bus::Options options;
+    bus_ = new dbus::MockBus{options};
+    object_manager_.reset(new brillo::dbus_utils::ExportedObjectManager{
+        bus_, dbus::ObjectPath{"/org/chromium/WebServer"}});
+    protocol_handler_.reset(new ProtocolHandler{"http", &server_});
+    dbus_protocol_handler_.reset(new DBusProtocolHandler{
+        object_manager_.get(),
+        dbus::ObjectPath{"/org/chromium/WebServer/ProtocolHandlers/1"},
+        protocol_handler_.get(), nullptr});
+    protocol_handler_->AddRequestHandler(
+        "/file", "GET",
+        std::unique_ptr<RequestHandlerInterface>(
+            new RecordingRequestHandler{&request_id_}));
+
+    // Listen on an ephemeral port so that tests don't collide.
+    Config::ProtocolHandler config;
+    config.socket_fd = socket(AF_INET6, SOCK_STREAM, 0);
+    ASSERT_NE(-1, config.socket_fd);
+    const int listen_fd = config.socket_fd;
+    ASSERT_TRUE(protocol_handler_->Start(config));
+    sockaddr_in6 addr = {};
+    socklen_t addr_len = sizeof(addr);
+    ASSERT_EQ(0, getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr),
+                             &addr_len));
+    port_ = ntohs(addr.sin6_port);
+
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    file_path_ = temp_dir_.GetPath().Append("contents");
+    ASSERT_EQ(static_cast<int>(sizeof(kFileContents) - 1),
+              base::WriteFile(file_path_, kFileContents,
+                              sizeof(kFileContents) - 1));
+  }
+
+  void TearDown() override {
+    dbus_protocol_handler_.reset();
+    protocol_handler_.reset();
+  }
+
+  // Connects to the protocol handler and sends a GET request for /file.
+  // Returns once the request has reached the request handler.
+  void SendRequest() {
+    client_fd_.reset(socket(AF_INET6, SOCK_STREAM, 0));
+    ASSERT_TRUE(client_fd_.is_valid());
+    sockaddr_in6 addr = {};
+    addr.sin6_family = AF_INET6;
+    addr.sin6_port = htons(port_);
+    addr.sin6_addr = in6addr_loopback;
+    ASSERT_EQ(0, HANDLE_EINTR(connect(client_fd_.get(),
+                                      reinterpret_cast<sockaddr*>(&addr),
+                                      sizeof(addr))));
+    ASSERT_TRUE(base::WriteFileDescriptor(client_fd_.get(), kRequest,
+                                          strlen(kRequest)));
+    ASSERT_EQ(0, fcntl(client_fd_.get(), F_SETFL, O_NONBLOCK));
+
+    for (int i = 0; i < kMaxIterations && request_id_.empty(); i++)
+      RunLoopOnce();
+    ASSERT_FALSE(request_id_.empty());
+  }
+
+  // Returns everything the server sends until it closes the connection.
+  std::string ReadResponse() {
+    std::string response;
+    for (int i = 0; i < kMaxIterations; i++) {
+      RunLoopOnce();
+      char buf[1024];
+      ssize_t size;
+      while ((size = HANDLE_EINTR(
+                  read(client_fd_.get(), buf, sizeof(buf)))) > 0) {
+        response.append(buf, size);
+      }
+      if (size == 0)
+        break;
+    }
+    return response;
+  }
+
+  base::ScopedFD OpenFile() {
+    return base::ScopedFD{open(file_path_.value().c_str(), O_RDONLY)};
+  }
+
+ protected:
+  void RunLoopOnce() {
+    base::RunLoop().RunUntilIdle();
+    base::PlatformThread::Sleep(base::TimeDelta::FromMilliseconds(10));
+  }
+
+  base::MessageLoopForIO message_loop_;
+  FakeServer server_;
+  scoped_refptr<dbus::MockBus> bus_;
+  std::unique_ptr<brillo::dbus_utils::ExportedObjectManager> object_manager_;
+  std::unique_ptr<ProtocolHandler> protocol_handler_;
+  std::unique_ptr<DBusProtocolHandler> dbus_protocol_handler_;
+  uint16_t port_{0};
+  std::string request_id_;
+  base::ScopedFD client_fd_;
+  base::ScopedTempDir temp_dir_;
+  base::FilePath file_path_;
+};
+
+TEST_F(DBusProtocolHandlerTest, CompleteRequestWithFile) {
+  SendRequest();
+
+  brillo::ErrorPtr error;
+  base::ScopedFD file = OpenFile();
+  ASSERT_TRUE(file.is_valid());
+  EXPECT_TRUE(dbus_protocol_handler_->CompleteRequestWithFile(
+      &error, request_id_, 200, {}, file, 4, 6));
+  EXPECT_EQ(nullptr, error.get());
+
+  std::string response = ReadResponse();
+  EXPECT_TRUE(
+      base::StartsWith(response, "HTTP/1.", base::CompareCase::SENSITIVE));
+  EXPECT_NE(std::string::npos, response.find(" 200 "));
+  EXPECT_TRUE(base::EndsWith(response, "\r\n\r\n456789",
+                             base::CompareCase::SENSITIVE));
+}
+
+TEST_F(DBusProtocolHandlerTest, CompleteRequestWithFileRejectsBadRange) {
+  SendRequest();
+
+  brillo::ErrorPtr error;
+  base::ScopedFD file = OpenFile();
+  ASSERT_TRUE(file.is_valid());
+  EXPECT_FALSE(dbus_protocol_handler_->CompleteRequestWithFile(
+      &error, request_id_, 200, {}, file, 4, 100));
+  EXPECT_NE(nullptr, error.get());
+
+  // The request is still pending, so it can be completed with the whole file.
+  error.reset();
+  EXPECT_TRUE(dbus_protocol_handler_->CompleteRequestWithFile(
+      &error, request_id_, 200, {}, file, 0, -1));
+  EXPECT_EQ(nullptr, error.get());
+
+  std::string response = ReadResponse();
+  EXPECT_TRUE(base::EndsWith(response, std::string{"\r\n\r\n"} + kFileContents,
+                             base::CompareCase::SENSITIVE));
+}
+
+TEST_F(DBusProtocolHandlerTest, CompleteRequestWithFileUnknownRequest) {
+  brillo::ErrorPtr error;
+  base::ScopedFD file = OpenFile();
+  ASSERT_TRUE(file.is_valid());
+  EXPECT_FALSE(dbus_protocol_handler_->CompleteRequestWithFile(
+      &error, "unknown", 200, {}, file, 0, -1));
+  EXPECT_NE(nullptr, error.get());
+}
+
+}  // namespace webservd
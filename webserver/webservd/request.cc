@@ -17,6 +17,9 @@
 #include <arpa/inet.h>
 #include <microhttpd.h>
 #include <netinet/in.h>
+#include <sys/stat.h>
+
+#include <utility>
 
 #include <base/bind.h>
 #include <base/files/file.h>
@@ -137,12 +140,6 @@ base::File Request::Complete(
   if (response_data_started_)
     return file;
 
-  response_status_code_ = status_code;
-  response_headers_.reserve(headers.size());
-  for (const auto& tuple : headers) {
-    response_headers_.emplace_back(std::get<0>(tuple), std::get<1>(tuple));
-  }
-
   // Create the pipe for response data.
   int pipe_fds[2] = {-1, -1};
   CHECK_EQ(0, pipe(pipe_fds));
@@ -152,6 +149,49 @@ base::File Request::Complete(
       pipe_fds[0], true, nullptr);
   CHECK(response_data_stream_);
 
+  StartResponse(status_code, headers, in_data_size);
+  return file;
+}
+
+bool Request::CompleteWithFile(
+    int32_t status_code,
+    const std::vector<std::tuple<std::string, std::string>>& headers,
+    base::File file,
+    int64_t offset,
+    int64_t in_data_size) {
+  if (response_data_started_ || !file.IsValid())
+    return false;
+
+  struct stat file_stat;
+  if (fstat(file.GetPlatformFile(), &file_stat) != 0 ||
+      !S_ISREG(file_stat.st_mode)) {
+    LOG(ERROR) << "Response data must be provided as a regular file";
+    return false;
+  }
+  const int64_t file_size = file_stat.st_size;
+  if (offset < 0 || offset > file_size)
+    return false;
+  if (in_data_size < 0)
+    in_data_size = file_size - offset;
+  if (in_data_size > file_size - offset)
+    return false;
+
+  response_file_ = std::move(file);
+  response_file_offset_ = offset;
+  StartResponse(status_code, headers, in_data_size);
+  return true;
+}
+
+void Request::StartResponse(
+    int32_t status_code,
+    const std::vector<std::tuple<std::string, std::string>>& headers,
+    int64_t in_data_size) {
+  response_status_code_ = status_code;
+  response_headers_.reserve(headers.size());
+  for (const auto& tuple : headers) {
+    response_headers_.emplace_back(std::get<0>(tuple), std::get<1>(tuple));
+  }
+
   response_data_size_ = in_data_size;
   response_data_started_ = true;
   const MHD_ConnectionInfo* info =
@@ -161,7 +201,6 @@ base::File Request::Complete(
   LogManager::OnRequestCompleted(base::Time::Now(), client_addr, method_, url_,
                                  version_, status_code, in_data_size);
   protocol_handler_->ScheduleWork();
-  return file;
 }
 
 bool Request::Complete(
@@ -228,9 +267,19 @@ void Request::EndRequestData() {
   }
 
   if (response_data_started_ && !response_data_finished_) {
-    MHD_Response* resp = MHD_create_response_from_callback(
-        response_data_size_, 4096, &Request::ResponseDataCallback, this,
-        nullptr);
+    MHD_Response* resp = nullptr;
+    if (response_file_.IsValid()) {
+      // libmicrohttpd takes ownership of the file descriptor and sends the
+      // data with sendfile() on non-TLS connections, so the body is never
+      // copied through this process.
+      resp = MHD_create_response_from_fd_at_offset64(
+          response_data_size_, response_file_.TakePlatformFile(),
+          response_file_offset_);
+    } else {
+      resp = MHD_create_response_from_callback(
+          response_data_size_, 4096, &Request::ResponseDataCallback, this,
+          nullptr);
+    }
     CHECK(resp);
     for (const auto& pair : response_headers_) {
       MHD_add_response_header(resp, pair.first.c_str(), pair.second.c_str());
@@ -85,6 +85,19 @@ class Request final {
       const std::vector<std::tuple<std::string, std::string>>& headers,
       int64_t in_data_size);
 
+  // Finishes the request and serves the reply data straight from |file|,
+  // starting at |offset|. |in_data_size| is the number of bytes to send, or -1
+  // to send the rest of the file. Only regular files are accepted, so that
+  // libmicrohttpd can use sendfile() instead of copying the data through a
+  // pipe. Returns false if the response was already started or the requested
+  // range is not within the file.
+  bool CompleteWithFile(
+      int32_t status_code,
+      const std::vector<std::tuple<std::string, std::string>>& headers,
+      base::File file,
+      int64_t offset,
+      int64_t in_data_size);
+
   // Helper function to provide the string data and mime type.
   bool Complete(
       int32_t status_code,
@@ -169,6 +182,12 @@ class Request final {
   // Callback to be called when data can be written to the output pipe again.
   void OnPipeAvailable(brillo::Stream::AccessMode mode);
 
+  // Stores the response status and headers and logs the completed request.
+  void StartResponse(
+      int32_t status_code,
+      const std::vector<std::tuple<std::string, std::string>>& headers,
+      int64_t in_data_size);
+
   // Forwards the request to the request handler.
   void ForwardRequestToHandler();
 
@@ -207,6 +226,11 @@ class Request final {
   int64_t response_data_size_{-1};
   // Data stream for the output/read end of the response data pipe.
   brillo::StreamPtr response_data_stream_;
+  // Regular file to serve the response from, used instead of
+  // |response_data_stream_| when the reply was provided as a file.
+  base::File response_file_;
+  // Offset within |response_file_| to start serving the data from.
+  int64_t response_file_offset_{0};
   std::vector<PairOfStrings> response_headers_;
   ProtocolHandler* protocol_handler_;
 